@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace griha::bench {
+
+// single measurement, it is reported as one CSV line
+struct result {
+    std::string suite;
+    std::string workload;
+    std::string allocator;
+    size_t param; // workload specific parameter: number of threads, elements, etc.
+    size_t ops;
+    double seconds;
+    size_t bytes = 0; // processed data of throughput workloads
+};
+
+using reporter = std::function<void(const result&)>;
+using benchmark = std::function<void(const reporter&)>;
+
+inline std::vector<std::pair<std::string, benchmark>>& registry() {
+    static std::vector<std::pair<std::string, benchmark>> benchmarks;
+    return benchmarks;
+}
+
+// registers suite of benchmarks on static initialization
+struct registrar {
+    registrar(std::string suite, benchmark fn) {
+        registry().emplace_back(std::move(suite), std::move(fn));
+    }
+};
+
+template <typename F>
+double measure(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// prevents optimizing out of computed value
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace griha::bench
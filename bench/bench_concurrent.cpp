@@ -0,0 +1,128 @@
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <allocator.h>
+#include <concurrent_allocator.h>
+
+#include "bench.h"
+
+using namespace std;
+using namespace griha;
+using namespace griha::bench;
+
+namespace {
+
+constexpr size_t chunk_n = 256ul;
+constexpr size_t batch_n = 64ul;
+constexpr size_t ops_per_thread = 1ul << 20;
+
+struct node { void* links[3]; };
+
+// allocator_arena shared between threads under mutex
+template <typename T>
+struct locked_arena {
+    allocator_arena<T, chunk_n> alloc;
+    mutex m;
+
+    T* allocate(size_t n) {
+        lock_guard<mutex> lock(m);
+        return alloc.allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        lock_guard<mutex> lock(m);
+        alloc.deallocate(p, n);
+    }
+};
+
+template <typename F>
+double run_threads(size_t threads_n, F&& f) {
+    atomic<size_t> ready = {0};
+    atomic<bool> start = {false};
+    vector<thread> workers;
+    for (size_t t = 0; t < threads_n; ++t)
+        workers.emplace_back([&, t] {
+            ++ready;
+            while (!start.load(memory_order_acquire));
+            f(t);
+        });
+    while (ready.load() != threads_n);
+    return measure([&] {
+        start.store(true, memory_order_release);
+        for (auto& w : workers)
+            w.join();
+    });
+}
+
+// every thread allocates batch of nodes and frees them
+template <typename Alloc>
+double local_free(Alloc& alloc, size_t threads_n) {
+    return run_threads(threads_n, [&alloc] (size_t) {
+        node* batch[batch_n];
+        for (size_t i = 0; i < ops_per_thread / batch_n; ++i) {
+            for (auto& p : batch)
+                p = alloc.allocate(1ul);
+            do_not_optimize(batch);
+            for (auto p : batch)
+                alloc.deallocate(p, 1ul);
+        }
+    });
+}
+
+// every thread allocates batch of nodes and passes it to the next thread for freeing,
+// buffer of received batch is reused for the next own batch
+template <typename Alloc>
+double remote_free(Alloc& alloc, size_t threads_n) {
+    vector<atomic<node**>> mailboxes(threads_n);
+    for (auto& m : mailboxes)
+        m.store(nullptr);
+    vector<unique_ptr<node*[]>> buffers;
+    for (size_t t = 0; t < threads_n; ++t)
+        buffers.emplace_back(new node*[batch_n]);
+
+    return run_threads(threads_n, [&] (size_t t) {
+        auto batch = buffers[t].get();
+        for (size_t i = 0; i < ops_per_thread / batch_n; ++i) {
+            for (size_t j = 0; j < batch_n; ++j)
+                batch[j] = alloc.allocate(1ul);
+            do_not_optimize(batch);
+
+            auto& out = mailboxes[(t + 1) % threads_n];
+            for (node** expected = nullptr;
+                 !out.compare_exchange_weak(expected, batch, memory_order_acq_rel);
+                 expected = nullptr);
+
+            while ((batch = mailboxes[t].exchange(nullptr, memory_order_acq_rel)) == nullptr);
+            for (size_t j = 0; j < batch_n; ++j)
+                alloc.deallocate(batch[j], 1ul);
+        }
+    });
+}
+
+template <typename Alloc>
+void run(const reporter& report, const char* name, size_t threads_n) {
+    {
+        auto alloc = make_unique<Alloc>();
+        auto seconds = local_free(*alloc, threads_n);
+        report({"concurrent", "local_free", name, threads_n, 2 * ops_per_thread * threads_n, seconds});
+    }
+    {
+        auto alloc = make_unique<Alloc>();
+        auto seconds = remote_free(*alloc, threads_n);
+        report({"concurrent", "remote_free", name, threads_n, 2 * ops_per_thread * threads_n, seconds});
+    }
+}
+
+registrar reg("concurrent", [] (const reporter& report) {
+    auto max_threads = max(1u, thread::hardware_concurrency());
+    for (size_t threads_n = 1; threads_n <= max_threads; threads_n *= 2) {
+        run<allocator<node>>(report, "std::allocator", threads_n);
+        run<locked_arena<node>>(report, "locked allocator_arena", threads_n);
+        run<concurrent_allocator_arena<node, chunk_n>>(report, "concurrent_allocator_arena", threads_n);
+    }
+});
+
+} // namespace
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <allocator.h>
+#include <bidirectional_list.h>
+#include <compact_list.h>
+#include <monotonic_allocator.h>
+#include <unrolled_list.h>
+
+#include "bench.h"
+
+using namespace std;
+using namespace griha;
+using namespace griha::bench;
+
+namespace {
+
+// workloads of main.cpp at realistic sizes:
+// fill, erase of random half with reinsertion, iteration and teardown
+struct phases {
+    double fill = 0.;
+    double erase_reinsert = 0.;
+    double iterate = 0.;
+    double teardown = 0.;
+};
+
+template <typename Alloc, typename... Args>
+phases map_phases(const vector<int>& keys, const Args&... args) {
+    using map_type = map<int, int, less<int>, typename allocator_traits<Alloc>::template rebind_alloc<pair<const int, int>>>;
+
+    phases ret;
+    auto m = make_unique<map_type>(args...);
+    ret.fill = measure([&] {
+        for (auto k : keys)
+            m->emplace(k, k);
+    });
+
+    ret.erase_reinsert = measure([&] {
+        for (size_t i = 0; i < keys.size(); i += 2)
+            m->erase(keys[i]);
+        for (size_t i = 0; i < keys.size(); i += 2)
+            m->emplace(keys[i], keys[i]);
+    });
+
+    ret.iterate = measure([&] {
+        long long sum = 0;
+        for (auto& v : *m)
+            sum += v.second;
+        do_not_optimize(sum);
+    });
+
+    ret.teardown = measure([&] { m.reset(); });
+    return ret;
+}
+
+template <typename List, typename... Args>
+phases list_phases(const vector<int>& keys, const Args&... args) {
+    using list_type = List;
+    using iterator = typename list_type::iterator;
+
+    phases ret;
+    auto l = make_unique<list_type>(args...);
+    vector<iterator> its;
+    its.reserve(keys.size());
+    ret.fill = measure([&] {
+        for (auto k : keys)
+            its.push_back(l->emplace(l->end(), k));
+    });
+
+    // positions are visited in random order, erased nodes are reinserted before survivors
+    shuffle(begin(its), end(its), mt19937(7));
+    auto half = its.size() / 2;
+    ret.erase_reinsert = measure([&] {
+        for (size_t i = 0; i < half; ++i)
+            l->erase(its[i]);
+        for (size_t i = half; i < its.size() && i - half < half; ++i)
+            l->emplace(its[i], keys[i]);
+    });
+    its.clear();
+
+    ret.iterate = measure([&] {
+        long long sum = 0;
+        for (auto v : *l)
+            sum += v;
+        do_not_optimize(sum);
+    });
+
+    ret.teardown = measure([&] { l.reset(); });
+    return ret;
+}
+
+// iterators of unrolled list are invalidated by modification,
+// so every other element is erased and reinserted in two passes
+template <typename Alloc, typename... Args>
+phases unrolled_phases(const vector<int>& keys, const Args&... args) {
+    using list_type = unrolled_list<int, 16, typename allocator_traits<Alloc>::template rebind_alloc<int>>;
+
+    phases ret;
+    auto l = make_unique<list_type>(args...);
+    ret.fill = measure([&] {
+        for (auto k : keys)
+            l->emplace(l->end(), k);
+    });
+
+    ret.erase_reinsert = measure([&] {
+        for (auto it = l->begin(); it != l->end();) {
+            it = l->erase(it);
+            if (it != l->end())
+                ++it;
+        }
+        size_t i = 0;
+        for (auto it = l->begin(); it != l->end(); i += 2) {
+            it = l->emplace(it, keys[i]);
+            ++it;
+            ++it;
+        }
+    });
+
+    ret.iterate = measure([&] {
+        long long sum = 0;
+        for (auto v : *l)
+            sum += v;
+        do_not_optimize(sum);
+    });
+
+    ret.teardown = measure([&] { l.reset(); });
+    return ret;
+}
+
+void report_phases(const reporter& report, const char* container, const string& name,
+                   size_t n, const phases& p) {
+    auto workload = [container] (const char* phase) { return string(container) + '_' + phase; };
+    report({"containers", workload("fill"), name, n, n, p.fill});
+    report({"containers", workload("erase_reinsert"), name, n, n / 2 * 2, p.erase_reinsert});
+    report({"containers", workload("iterate"), name, n, n, p.iterate});
+    report({"containers", workload("teardown"), name, n, n, p.teardown});
+}
+
+template <typename Alloc, typename... Args>
+void run(const reporter& report, const string& name, const vector<int>& keys, const Args&... args) {
+    report_phases(report, "map", name, keys.size(), map_phases<Alloc>(keys, args...));
+    using int_alloc = typename allocator_traits<Alloc>::template rebind_alloc<int>;
+    report_phases(report, "list", name, keys.size(),
+                  list_phases<bidirectional_list<int, int_alloc>>(keys, args...));
+    report_phases(report, "compact_list", name, keys.size(),
+                  list_phases<compact_list<int, uint32_t, 64, int_alloc>>(keys, args...));
+    report_phases(report, "unrolled_list", name, keys.size(), unrolled_phases<Alloc>(keys, args...));
+}
+
+// traversal of list scattered by sort over random keys, before and after incremental
+// defragmentation by steps of 1024 nodes
+template <typename Alloc>
+void defragmentation(const reporter& report, const string& name, const vector<int>& keys) {
+    bidirectional_list<int, Alloc> l;
+    for (size_t i = 0; i < keys.size(); ++i)
+        l.push_back(int(i));
+    l.sort([&keys] (int a, int b) { return keys[size_t(a)] < keys[size_t(b)]; });
+
+    auto iterate = [&l] {
+        return measure([&l] {
+            long long sum = 0;
+            for (auto v : l)
+                sum += v;
+            do_not_optimize(sum);
+        });
+    };
+
+    auto n = keys.size();
+    report({"containers", "list_iterate_scattered", name, n, n, iterate()});
+    report({"containers", "list_defragment", name, n, n, measure([&l] {
+        while (!l.defragment(1024));
+    })});
+    report({"containers", "list_iterate_defragmented", name, n, n, iterate()});
+}
+
+// single elements freed in random order, so chunks become empty and are released
+// while free list holds elements of many other chunks
+template <typename Alloc>
+void random_free(const reporter& report, const string& name, size_t n) {
+    Alloc alloc;
+    vector<long*> ps(n);
+    for (auto& p : ps)
+        p = alloc.allocate(1);
+    shuffle(begin(ps), end(ps), mt19937(3));
+    report({"containers", "arena_random_free", name, n, n, measure([&] {
+        for (auto p : ps)
+            alloc.deallocate(p, 1);
+    })});
+}
+
+template <size_t... ChunkN>
+void run_arenas(const reporter& report, const vector<int>& keys) {
+    (run<allocator_arena<int, ChunkN>>(report, "allocator_arena<" + to_string(ChunkN) + '>', keys), ...);
+    (defragmentation<allocator_arena<int, ChunkN>>(report, "allocator_arena<" + to_string(ChunkN) + '>', keys), ...);
+    (random_free<allocator_arena<long, ChunkN>>(report, "allocator_arena<" + to_string(ChunkN) + '>', keys.size()), ...);
+    (random_free<allocator_arena<long, ChunkN, reclaim_never>>(
+        report, "allocator_arena<" + to_string(ChunkN) + ",reclaim_never>", keys.size()), ...);
+}
+
+registrar reg("containers", [] (const reporter& report) {
+    for (size_t n = 1ul << 12; n <= (1ul << 18); n <<= 3) {
+        vector<int> keys(n);
+        iota(begin(keys), end(keys), 0);
+        shuffle(begin(keys), end(keys), mt19937(42));
+
+        run<allocator<int>>(report, "std::allocator", keys);
+        run_arenas<64ul, 256ul, 1024ul, 4096ul>(report, keys);
+
+        monotonic_arena<> arena(1ul << 16);
+        run<monotonic_allocator<int>>(report, "monotonic_allocator", keys, monotonic_allocator<int>(arena));
+    }
+});
+
+} // namespace
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+
+#include <big_integer.h>
+#include <factorial.h>
+#include <parallel.h>
+#include <parallel_factorial.h>
+
+#include "bench.h"
+
+using namespace std;
+using namespace griha;
+using namespace griha::bench;
+
+namespace {
+
+big_uint random_number(mt19937_64& gen, size_t limbs) {
+    big_uint ret;
+    for (size_t i = 0; i < limbs; ++i) {
+        ret <<= 32;
+        ret += big_uint(gen() | 1u);
+    }
+    return ret;
+}
+
+// multiplication of operands of equal length, param is number of limbs
+void multiplication(const reporter& report) {
+    mt19937_64 gen(1);
+    for (size_t limbs = 64; limbs <= 8192; limbs <<= 2) {
+        auto a = random_number(gen, limbs), b = random_number(gen, limbs);
+        report({"factorial", "multiply", "schoolbook", limbs, 1, measure([&] {
+            do_not_optimize(multiply_schoolbook(a, b).limbs().size());
+        })});
+        report({"factorial", "multiply", "karatsuba", limbs, 1, measure([&] {
+            do_not_optimize((a * b).limbs().size());
+        })});
+    }
+}
+
+// n! by naive accumulation, by binary splitting and by binary splitting on threads,
+// param is n, number of threads is in name of parallel rows
+void factorials(const reporter& report) {
+    for (unsigned n : {10000u, 50000u}) {
+        report({"factorial", "factorial", "naive", n, n, measure([&] {
+            big_uint ret(1);
+            for (unsigned i = 2; i <= n; ++i)
+                ret *= i;
+            do_not_optimize(ret.limbs().size());
+        })});
+
+        report({"factorial", "factorial", "binary_splitting", n, n, measure([&] {
+            do_not_optimize(big_fact(n).limbs().size());
+        })});
+
+        size_t max_threads = max(4u, thread::hardware_concurrency());
+        for (size_t threads_n = 2; threads_n <= max_threads; threads_n <<= 1) {
+            thread_pool pool(threads_n);
+            report({"factorial", "factorial", "parallel_" + to_string(threads_n), n, n, measure([&] {
+                do_not_optimize(big_fact(n, pool).limbs().size());
+            })});
+        }
+    }
+
+    report({"factorial", "binomial", "prime_powers", 100000, 1, measure([&] {
+        do_not_optimize(big_binomial(100000, 50000).limbs().size());
+    })});
+}
+
+registrar reg("factorial", [] (const reporter& report) {
+    multiplication(report);
+    factorials(report);
+});
+
+} // namespace
@@ -0,0 +1,88 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include <allocator.h>
+#include <bidirectional_list.h>
+#include <list_io.h>
+
+#include "bench.h"
+
+using namespace std;
+using namespace griha;
+using namespace griha::bench;
+
+namespace {
+
+struct record {
+    double values[7];
+    long key;
+};
+
+struct page {
+    char bytes[4096];
+};
+
+constexpr size_t chunk_n = 1ul << 16;
+
+// snapshots of list by elements through streams and by list_io,
+// loading of the whole file and reading by chunks, param is number of elements
+template <typename T>
+void run(const reporter& report, const string& name, size_t n) {
+    using list_type = bidirectional_list<T, allocator_arena<T, 4096>>;
+
+    auto path = "/tmp/griha_bench_" + to_string(getpid()) + ".list";
+    auto bytes = n * sizeof(T);
+    list_type l;
+    for (size_t i = 0; i < n; ++i)
+        l.push_back(T{});
+
+    report({"list_io", "dump_ostream", name, n, n, measure([&] {
+        ofstream os(path, ios::binary);
+        for (auto& v : l)
+            os.write(reinterpret_cast<const char*>(&v), sizeof(v));
+    }), bytes});
+
+    report({"list_io", "dump_list_io", name, n, n, measure([&] { dump(l, path); }), bytes});
+
+    report({"list_io", "load_istream", name, n, n, measure([&] {
+        list_type loaded;
+        ifstream is(path, ios::binary);
+        is.seekg(sizeof(list_file_header));
+        T v;
+        while (is.read(reinterpret_cast<char*>(&v), sizeof(v)))
+            loaded.push_back(v);
+        do_not_optimize(loaded.size());
+    }), bytes});
+
+    report({"list_io", "load_list_io", name, n, n, measure([&] {
+        list_type loaded;
+        load(loaded, path);
+        do_not_optimize(loaded.size());
+    }), bytes});
+
+    report({"list_io", "read_chunks", name, n, n, measure([&] {
+        details::file f(path, O_RDONLY);
+        list_reader<T> reader(f.fd());
+        list_type chunk;
+        size_t read = 0;
+        while (auto m = reader.read(chunk, chunk_n))
+            read += m;
+        do_not_optimize(read);
+    }), bytes});
+
+    remove(path.c_str());
+}
+
+registrar reg("list_io", [] (const reporter& report) {
+    for (size_t n = 1ul << 16; n <= (1ul << 22); n <<= 3)
+        run<long>(report, "long", n);
+    for (size_t n = 1ul << 13; n <= (1ul << 19); n <<= 3)
+        run<record>(report, "record64", n);
+    for (size_t n = 1ul << 10; n <= (1ul << 14); n <<= 2)
+        run<page>(report, "page4k", n);
+});
+
+} // namespace
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include <allocator.h>
+#include <bidirectional_list.h>
+#include <parallel.h>
+
+#include "bench.h"
+
+using namespace std;
+using namespace griha;
+using namespace griha::bench;
+
+namespace {
+
+constexpr size_t elements_n = 1ul << 21;
+
+using list_type = bidirectional_list<double, allocator_arena<double, 4096>>;
+
+// read-only passes over list of doubles with segments computed once per pool,
+// param is number of threads, so speedup is ratio of seconds to those of 1 thread
+void run(const reporter& report, const list_type& l, size_t threads_n) {
+    thread_pool pool(threads_n);
+    auto name = "bidirectional_list";
+
+    list_segments<list_type::const_iterator> segments(l, 1);
+    report({"parallel", "split", name, threads_n, l.size(), measure([&] {
+        segments = split(l, pool.size() * parallel::oversubscription);
+    })});
+
+    report({"parallel", "count_if", name, threads_n, l.size(), measure([&] {
+        do_not_optimize(parallel::count_if(pool, segments, [] (double v) { return v > 0.5; }));
+    })});
+
+    report({"parallel", "transform_reduce", name, threads_n, l.size(), measure([&] {
+        do_not_optimize(parallel::transform_reduce(pool, segments, 0., plus<>(),
+                                                   [] (double v) { return sqrt(v) * v; }));
+    })});
+
+    report({"parallel", "for_each", name, threads_n, l.size(), measure([&] {
+        parallel::for_each(pool, segments, [] (const double& v) { do_not_optimize(sin(v)); });
+    })});
+
+    report({"parallel", "count_if_with_split", name, threads_n, l.size(), measure([&] {
+        do_not_optimize(parallel::count_if(pool, l, [] (double v) { return v > 0.5; }));
+    })});
+}
+
+registrar reg("parallel", [] (const reporter& report) {
+    list_type l;
+    for (size_t i = 0; i < elements_n; ++i)
+        l.push_back(double(i % 1000) / 1000.);
+
+    size_t max_threads = max(4u, thread::hardware_concurrency());
+    for (size_t threads_n = 1; threads_n <= max_threads; threads_n <<= 1)
+        run(report, l, threads_n);
+});
+
+} // namespace
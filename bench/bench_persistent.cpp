@@ -0,0 +1,61 @@
+#include <cstdio>
+#include <string>
+
+#include <unistd.h>
+
+#include <bidirectional_list.h>
+#include <persistent_arena.h>
+
+#include "bench.h"
+
+using namespace std;
+using namespace griha;
+using namespace griha::bench;
+
+namespace {
+
+using persistent_list = bidirectional_list<long, persistent_allocator<long>>;
+
+// startup with list of n elements: rebuild in heap, build in persistent arena with sync
+// and reopening of built arena with first traversal, param is n
+void startup(const reporter& report, size_t n) {
+    auto path = "/tmp/griha_bench_" + to_string(getpid()) + ".arena";
+    remove(path.c_str());
+    auto capacity = n * 64 + (1ul << 20);
+
+    report({"persistent", "rebuild", "std::allocator", n, n, measure([n] {
+        bidirectional_list<long> l;
+        for (size_t i = 0; i < n; ++i)
+            l.push_back(long(i));
+        do_not_optimize(l.size());
+    })});
+
+    report({"persistent", "build", "persistent_arena", n, n, measure([&] {
+        persistent_arena arena(path, capacity);
+        auto& l = arena.construct<persistent_list>("list", persistent_allocator<long>(arena));
+        for (size_t i = 0; i < n; ++i)
+            l.push_back(long(i));
+    })});
+
+    report({"persistent", "reopen", "persistent_arena", n, 1, measure([&] {
+        persistent_arena arena(path, capacity);
+        do_not_optimize(arena.find<persistent_list>("list")->size());
+    })});
+
+    report({"persistent", "reopen_iterate", "persistent_arena", n, n, measure([&] {
+        persistent_arena arena(path, capacity);
+        long sum = 0;
+        for (auto v : *arena.find<persistent_list>("list"))
+            sum += v;
+        do_not_optimize(sum);
+    })});
+
+    remove(path.c_str());
+}
+
+registrar reg("persistent", [] (const reporter& report) {
+    for (size_t n = 1ul << 14; n <= (1ul << 20); n <<= 3)
+        startup(report, n);
+});
+
+} // namespace
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <list>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <bidirectional_list.h>
+#include <memory_resource.h>
+
+#include "bench.h"
+
+using namespace std;
+using namespace griha;
+using namespace griha::bench;
+
+namespace {
+
+constexpr size_t rounds_n = 8ul;
+
+// map and list filled together from the same resource, then half of map is erased
+void mixed(pmr::memory_resource* resource, const vector<int>& keys) {
+    pmr::map<int, int> m(resource);
+    pmr::list<int> l(resource);
+    bidirectional_list<int, pmr::polymorphic_allocator<int>> bl(resource);
+    for (auto k : keys) {
+        m.emplace(k, k);
+        l.push_back(k);
+        bl.emplace(bl.end(), k);
+    }
+    for (size_t i = 0; i < keys.size(); i += 2)
+        m.erase(keys[i]);
+    do_not_optimize(m.size() + l.size() + bl.size());
+}
+
+template <typename Resource, typename... Args>
+void run(const reporter& report, const char* name, const vector<int>& keys, Args... args) {
+    auto resource = make_unique<Resource>(args...);
+    auto seconds = measure([&] {
+        for (size_t r = 0; r < rounds_n; ++r)
+            mixed(resource.get(), keys);
+    });
+    report({"pmr", "map_list_fill_erase", name, keys.size(), rounds_n * keys.size() * 4, seconds});
+}
+
+registrar reg("pmr", [] (const reporter& report) {
+    for (size_t n = 1ul << 10; n <= (1ul << 18); n <<= 4) {
+        vector<int> keys(n);
+        iota(begin(keys), end(keys), 0);
+        shuffle(begin(keys), end(keys), mt19937(42));
+
+        struct new_delete : pmr::memory_resource {
+            void* do_allocate(size_t b, size_t a) override { return pmr::new_delete_resource()->allocate(b, a); }
+            void do_deallocate(void* p, size_t b, size_t a) override { pmr::new_delete_resource()->deallocate(p, b, a); }
+            bool do_is_equal(const pmr::memory_resource& o) const noexcept override { return this == &o; }
+        };
+
+        run<new_delete>(report, "new_delete_resource", keys);
+        run<pmr::unsynchronized_pool_resource>(report, "unsynchronized_pool_resource", keys);
+        run<pmr::monotonic_buffer_resource>(report, "monotonic_buffer_resource", keys);
+        run<arena_pool_resource<>>(report, "arena_pool_resource", keys);
+        run<arena_monotonic_resource<>>(report, "arena_monotonic_resource", keys);
+    }
+});
+
+} // namespace
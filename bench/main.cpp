@@ -0,0 +1,27 @@
+#include <iostream>
+#include <algorithm>
+
+#include "bench.h"
+
+using namespace std;
+using namespace griha::bench;
+
+// usage: allocator_bench [suite...]
+// results are written to standard output as CSV
+int main(int argc, char* argv[]) {
+    vector<string> suites(argv + 1, argv + argc);
+
+    cout << "suite,workload,allocator,param,ops,seconds,ns_per_op,mb_per_s" << endl;
+    auto report = [] (const result& r) {
+        cout << r.suite << ',' << r.workload << ',' << r.allocator << ','
+             << r.param << ',' << r.ops << ',' << r.seconds << ','
+             << (r.ops != 0 ? r.seconds * 1e9 / r.ops : 0.) << ','
+             << (r.bytes != 0 ? r.bytes / r.seconds / 1e6 : 0.) << endl;
+    };
+
+    for (auto& [suite, fn] : registry())
+        if (suites.empty() || find(begin(suites), end(suites), suite) != end(suites))
+            fn(report);
+
+    return 0;
+}
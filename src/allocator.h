@@ -1,84 +1,264 @@
 #pragma once
 
+#include <algorithm>
+#include <limits>
+#include <memory>
 #include <stdexcept>
-#include <bitset>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "arena_stats.h"
+#include "bitmap.h"
+#include "chunk_source.h"
 
 namespace griha {
 
-template <typename T, size_t ChunkN>
+// Policies of releasing of chunks which became empty on deallocation.
+// Policy is asked when a chunk becomes empty with number of empty chunks (including this one)
+// and number of all chunks of arena. If it returns true the chunk is released.
+
+// never releases chunks until destruction of arena
+struct reclaim_never {
+    static constexpr bool release(size_t /*empty_chunks*/, size_t /*chunks*/) { return false; }
+};
+
+// keeps at most N empty chunks in reserve
+template <size_t N>
+struct reclaim_keep_spare {
+    static constexpr bool release(size_t empty_chunks, size_t /*chunks*/) { return empty_chunks > N; }
+};
+
+// releases empty chunks while number of chunks is above high-water mark N
+template <size_t N>
+struct reclaim_high_water {
+    static constexpr bool release(size_t /*empty_chunks*/, size_t chunks) { return chunks > N; }
+};
+
+// Policies of sizing of new chunks.
+// Policy gets capacity of the last created chunk (0 for the first one) and initial capacity
+// and returns capacity of the next chunk. It also limits capacity of any chunk,
+// requests above the limit are served by dedicated large blocks.
+
+// all chunks have initial capacity
+struct grow_fixed {
+    static constexpr size_t next(size_t /*last_n*/, size_t chunk_n) { return chunk_n; }
+    static constexpr size_t max(size_t chunk_n) { return chunk_n; }
+};
+
+// every next chunk is Factor times larger than the last one up to MaxFactor times of initial capacity
+template <size_t Factor = 2, size_t MaxFactor = 64>
+struct grow_geometric {
+    static constexpr size_t next(size_t last_n, size_t chunk_n) {
+        return last_n == 0 ? chunk_n : std::min(last_n * Factor, max(chunk_n));
+    }
+    static constexpr size_t max(size_t chunk_n) { return chunk_n * MaxFactor; }
+};
+
+// Policies of placement of sequences of elements in chunks.
+// Chunks are tried from the most recently available one (first fit), from the chunk of previous
+// allocation (next fit) or all of them are compared by their largest free runs (best fit).
+// Full chunks are not visited by any of them.
+
+struct first_fit {
+    static constexpr bool roving = false;
+    static constexpr bool best = false;
+};
+
+// roving cursor spreads allocations over chunks
+struct next_fit {
+    static constexpr bool roving = true;
+    static constexpr bool best = false;
+};
+
+// the shortest free run of the chunk with the smallest sufficient largest free run
+struct best_fit {
+    static constexpr bool roving = false;
+    static constexpr bool best = true;
+};
+
+template <typename T, size_t ChunkN,
+          typename ReclaimPolicy = reclaim_keep_spare<1>,
+          typename GrowthPolicy = grow_fixed,
+          typename UpstreamSource = malloc_source,
+          typename Stats = no_stats,
+          typename FitPolicy = first_fit>
 class allocator_arena {
 
+    // Headers of chunks are kept in dense table apart from elements,
+    // so search of free elements touches only headers and states but not payload.
+    // Block of elements starts with index of its header in the table.
     struct chunk {
-        std::bitset<ChunkN> state;
-        chunk* next;
-        T data[ChunkN];
+        T* data;
+        size_t capacity;
+        size_t used; // number of allocated elements
+        std::unique_ptr<bits::word_type[]> words;
+        size_t largest; // upper bound of the longest free run in state, exact value if exact is set
+        bool exact;
+        size_t slot;    // position in list of available chunks or npos
+        T* free_list;   // single freed elements of the chunk
+        size_t listed;  // position in list of chunks having free lists or npos
+
+        bitmap_view state() const { return {words.get(), capacity}; }
     };
 
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    // blocks above maximal chunk capacity are allocated separately with header preceding elements
+    struct large_block {
+        large_block* prev;
+        large_block* next;
+        size_t size; // in bytes including header
+    };
+
+    static constexpr size_t align_up(size_t v, size_t a) { return (v + a - 1) / a * a; }
+
+    static constexpr size_t cache_line = 64;
+
+    // elements start on cache line or on alignment of over-aligned T
+    static constexpr size_t data_offset = align_up(sizeof(size_t), std::max(cache_line, alignof(T)));
+
+    static constexpr size_t chunk_size(size_t capacity) {
+        return data_offset + capacity * sizeof(T);
+    }
+
+    static constexpr size_t large_offset = align_up(sizeof(large_block), alignof(T));
+
+    // single freed elements are kept in intrusive LIFO lists threaded through their storage,
+    // they stay busy in chunk state until the lists are flushed by allocation of sequence.
+    // Every chunk has its own list, so released chunk takes its elements away at once,
+    // and the chunk of the last freed element is the last one in listed_.
+    static constexpr bool use_free_list = sizeof(T) >= sizeof(T*);
+
 public:
     template <typename U>
     struct rebind {
-        using other = allocator_arena<U, ChunkN>;
+        using other = allocator_arena<U, ChunkN, ReclaimPolicy, GrowthPolicy, UpstreamSource, Stats, FitPolicy>;
     };
 
     using value_type = T;
     using size_type = size_t;
     using difference_type = ptrdiff_t;
 
+    // Arena is owned by its container and is not copied. Moved or swapped container takes
+    // its arena together with elements, copy of container gets new arena.
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
 public:
+    allocator_arena() : allocator_arena(ChunkN) {}
+
+    // initial capacity of chunks is set at runtime
+    explicit allocator_arena(size_type chunk_n)
+        : chunk_n_(chunk_n),
+          max_chunk_n_(GrowthPolicy::max(chunk_n)),
+          // all blocks of chunks are allocated aligned on size of the largest one (power of two),
+          // so block of any element and index of its chunk are found by masking of its address
+          chunk_alignment_(bits::ceil_pow2(chunk_size(max_chunk_n_))) {}
+
+    allocator_arena(const allocator_arena&) = delete;
+    allocator_arena& operator= (const allocator_arena&) = delete;
+
+    // moved-from arena is left empty with the same configuration
+    allocator_arena(allocator_arena&& src) : allocator_arena(src.chunk_n_) { swap(src); }
+
+    allocator_arena& operator= (allocator_arena&& rhs) {
+        allocator_arena t(std::move(rhs));
+        swap(t);
+        return *this;
+    }
+
     ~allocator_arena() {
-        for (auto p = head_; p != nullptr;) {
+        for (auto& ch : chunks_)
+            source_.deallocate(block_of(ch), chunk_size(ch.capacity));
+        for (auto p = large_; p != nullptr;) {
             auto t = p;
             p = p->next;
-            free(t);
+            source_.deallocate(t, t->size);
         }
     }
 
     T* allocate(size_type n) {
-        if (n > ChunkN)
-            throw std::bad_alloc(); // only sequentially allocation is supported
-
         if (n == 0)
             return nullptr;
 
-        // find sequence of n free elements
-        auto p = head_;
-        for (; p != nullptr; p = p->next) {
-            auto& state = p->state;
-            for (size_t i = find_zero_bit(state), j = i + 1;
-                 i < state.size();
-                 i = find_zero_bit(state, j + 1), j = i + 1) {
-
-                bool found;
-                std::tie(j, found) = find_non_zero_bit_n(state, n - 1, j); // found if n is achieved to 0
-                if (!found)
-                    continue;
-                set_bits(state, i, j); // set elements are busy
-                return &p->data[i]; // and return pointer on first element
+        auto t = stats_.start();
+        if (n > max_chunk_n_) {
+            auto ret = allocate_large(n);
+            stats_.on_allocate_large(ret, n * sizeof(T), t);
+            return ret;
+        }
+
+        auto ret = allocate_chunked(n);
+        stats_.on_allocate(ret, n * sizeof(T), t);
+        return ret;
+    }
+
+    // Allocates n elements close to hint, an element allocated by this arena in a chunk.
+    // Single element is taken from free list of hint's chunk if it has one. Otherwise elements
+    // are placed in the first free run following hint in its chunk (right after it if possible),
+    // otherwise in the first run of the chunk, otherwise anywhere as allocate does.
+    // Only free list of hint's chunk is flushed for sequences, other freed elements stay listed.
+    T* allocate_near(size_type n, const T* hint) {
+        if (hint == nullptr || n == 0 || n > max_chunk_n_)
+            return allocate(n);
+
+        auto t = stats_.start();
+        auto p = const_cast<T*>(hint);
+        auto index = index_of(p);
+        auto& ch = chunks_[index];
+        stats_.on_lookup();
+        if constexpr (use_free_list) {
+            if (ch.listed != npos && n == 1) {
+                auto ret = pop_free(index);
+                acquire(index, 1ul);
+                stats_.on_allocate(ret, sizeof(T), t);
+                return ret;
             }
+            if (ch.listed != npos)
+                flush_chunk(index);
+        }
+        if (ch.largest >= n) {
+            auto state = ch.state();
+            size_type from = p - ch.data + 1;
+            auto i = state.find_zero_run(n, from);
+            auto scanned = i - from + n;
+            if (i == state.npos()) {
+                i = state.find_zero_run(n);
+                scanned = ch.capacity - from + i + n;
+            }
+            if (i != state.npos()) {
+                stats_.on_scan(1, scanned);
+                auto ret = take(index, i, n);
+                stats_.on_allocate(ret, n * sizeof(T), t);
+                return ret;
+            }
+            stats_.on_scan(1, ch.capacity);
+            ch.largest = n - 1;
+            ch.exact = false;
+            update_available(index);
         }
-        // no suitable chunk, create new
-        p = reinterpret_cast<chunk*>(malloc(sizeof(chunk)));
-        if (p == nullptr)
-            throw std::bad_alloc();
-        
-        memset(p, 0, sizeof(chunk));
-        p->next = head_;
-        head_ = p;
 
-        // dow allocate in new chunk
-        set_bits(head_->state, 0, n);
-        return head_->data;
+        auto ret = allocate_chunked(n);
+        stats_.on_allocate(ret, n * sizeof(T), t);
+        return ret;
     }
 
     void deallocate(T* p, size_type n) {
-        for (auto ch = head_; ch != nullptr; ch = ch->next) {
-            if (ch->data > p || &ch->data[ChunkN - 1] < p)
-                continue;
-            size_t i = p - ch->data;
-            if (i + n > ChunkN)
-                throw std::invalid_argument("n should contain value as in corresponding call of allocate");
-            set_bits(ch->state, i, i + n, false);
-        }
+        if (p == nullptr)
+            return;
+
+        auto t = stats_.start();
+        if (n > max_chunk_n_)
+            deallocate_large(p);
+        else
+            deallocate_chunked(p, n);
+        stats_.on_deallocate(p, n * sizeof(T), t);
     }
 
     template <typename U, typename... Args>
@@ -87,24 +267,384 @@ public:
     }
 
     template <typename U> void destroy(U* p) { p->~U(); }
+
+    // releases empty chunks keeping at most keep of them in reserve
+    void trim(size_type keep = 0ul) {
+        if constexpr (use_free_list)
+            flush_free_list();
+
+        // released chunk is replaced by the last one which is already visited
+        for (auto i = chunks_.size(); i-- != 0 && empty_chunks_ > keep;)
+            if (chunks_[i].used == 0)
+                release_chunk(i);
+    }
+
+    size_type chunk_count() const { return chunks_.size(); }
+
+    // maximal number of elements allocated in chunks, larger requests get dedicated blocks
+    size_type max_chunk_size() const { return max_chunk_n_; }
+
+    // any run of adjacent allocated elements up to this size may be deallocated at once,
+    // even if it is a part of allocated sequence or spans several of them
+    size_type max_piecewise_size() const { return max_chunk_n_; }
+
+    const Stats& stats() const { return stats_; }
+    Stats& stats() { return stats_; }
+
+    void swap(allocator_arena& other) {
+        std::swap(source_, other.source_);
+        std::swap(chunk_n_, other.chunk_n_);
+        std::swap(max_chunk_n_, other.max_chunk_n_);
+        std::swap(chunk_alignment_, other.chunk_alignment_);
+        std::swap(last_chunk_n_, other.last_chunk_n_);
+        chunks_.swap(other.chunks_);
+        available_.swap(other.available_);
+        std::swap(cursor_, other.cursor_);
+        std::swap(large_, other.large_);
+        listed_.swap(other.listed_);
+        std::swap(empty_chunks_, other.empty_chunks_);
+        std::swap(stats_, other.stats_);
+    }
+
+    // elements of arena are deallocated only by itself
+    friend bool operator== (const allocator_arena& lhs, const allocator_arena& rhs) { return &lhs == &rhs; }
+    friend bool operator!= (const allocator_arena& lhs, const allocator_arena& rhs) { return &lhs != &rhs; }
+
+    // counters collected by Stats policy together with current layout of chunks,
+    // elements kept in free lists are counted as busy
+    arena_stats_snapshot stats_snapshot() const {
+        arena_stats_snapshot ret;
+        ret.chunks = chunks_.size();
+        for (auto& ch : chunks_) {
+            auto state = ch.state();
+            ret.free_slots += ch.capacity - state.count();
+            ret.largest_free_run = std::max(ret.largest_free_run, state.largest_zero_run());
+        }
+        stats_.fill(ret);
+        return ret;
+    }
+
 private:
-    inline size_t find_zero_bit(const std::bitset<ChunkN>& state, size_t pos = 0ul) {
-        for (; pos < state.size() && state[pos]; ++pos);
-        return pos;
+    T* allocate_chunked(size_type n) {
+        if constexpr (use_free_list) {
+            if (n == 1 && !listed_.empty()) {
+                auto index = listed_.back();
+                auto ret = pop_free(index);
+                acquire(index, 1ul);
+                return ret;
+            }
+        }
+
+        if (auto ret = find_free(n))
+            return ret;
+
+        if constexpr (use_free_list) {
+            if (!listed_.empty()) {
+                flush_free_list();
+                if (auto ret = find_free(n))
+                    return ret;
+            }
+        }
+
+        // no suitable chunk, create new
+        auto capacity = std::max(GrowthPolicy::next(last_chunk_n_, chunk_n_), n);
+        if (chunks_.size() == chunks_.capacity()) {
+            // lists of available chunks and of chunks with free lists never grow on deallocation
+            chunks_.reserve(std::max(2 * chunks_.size(), size_type(4)));
+            available_.reserve(chunks_.capacity());
+            listed_.reserve(chunks_.capacity());
+        }
+        auto words = std::make_unique<bits::word_type[]>(bits::words_for(capacity));
+        auto block = static_cast<char*>(source_.allocate(chunk_size(capacity), chunk_alignment_));
+        set_index(block, chunks_.size());
+        chunks_.push_back({reinterpret_cast<T*>(block + data_offset), capacity, n, std::move(words),
+                           capacity - n, true, npos, nullptr, npos});
+        last_chunk_n_ = capacity;
+
+        // dow allocate in new chunk
+        auto& ch = chunks_.back();
+        ch.state().set(0, n);
+        update_available(chunks_.size() - 1);
+        return ch.data;
+    }
+
+    void deallocate_chunked(T* p, size_type n) {
+        auto index = index_of(p);
+        auto& ch = chunks_[index];
+        stats_.on_lookup();
+        size_t i = p - ch.data;
+        if (i + n > ch.capacity)
+            throw std::invalid_argument("n should contain value as in corresponding call of allocate");
+
+        ch.used -= n;
+        if (use_free_list && n == 1)
+            push_free(index, p);
+        else {
+            ch.state().reset(i, i + n);
+            release_run(index);
+        }
+
+        if (ch.used != 0)
+            return;
+
+        ++empty_chunks_;
+        if (ReclaimPolicy::release(empty_chunks_, chunks_.size()))
+            release_chunk(index);
+    }
+
+    char* block_of(T* p) const {
+        return reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(p) & ~(chunk_alignment_ - 1));
     }
 
-    inline std::pair<size_t, bool>
-    find_non_zero_bit_n(const std::bitset<ChunkN>& state, size_t n, size_t pos = 0ul) {
-        for (; pos < state.size() && n != 0 && !state[pos]; ++pos, --n);
-        return {pos, n == 0};
+    static char* block_of(const chunk& ch) { return reinterpret_cast<char*>(ch.data) - data_offset; }
+
+    size_type index_of(T* p) const {
+        size_type ret;
+        memcpy(&ret, block_of(p), sizeof(ret));
+        return ret;
+    }
+
+    static void set_index(char* block, size_type index) { memcpy(block, &index, sizeof(index)); }
+
+    void acquire(size_type index, size_type n) {
+        auto& ch = chunks_[index];
+        if (ch.used == 0)
+            --empty_chunks_;
+        ch.used += n;
+        ch.largest = std::min(ch.largest, ch.capacity - ch.used);
+        update_available(index);
+    }
+
+    // elements are released in state, so free runs may be merged
+    void release_run(size_type index) {
+        auto& ch = chunks_[index];
+        ch.largest = ch.capacity - ch.used;
+        ch.exact = false;
+        update_available(index);
+    }
+
+    // the last chunk takes place of released one to keep the table dense
+    void release_chunk(size_type index) {
+        auto& ch = chunks_[index];
+        if (ch.slot != npos)
+            remove_available(ch);
+        if (ch.listed != npos)
+            unlist(ch);
+        source_.deallocate(block_of(ch), chunk_size(ch.capacity));
+        if (index != chunks_.size() - 1) {
+            ch = std::move(chunks_.back());
+            set_index(block_of(ch), index);
+            if (ch.slot != npos)
+                available_[ch.slot] = index;
+            if (ch.listed != npos)
+                listed_[ch.listed] = index;
+        }
+        chunks_.pop_back();
+        --empty_chunks_;
     }
 
-    inline void set_bits(std::bitset<ChunkN>& state, size_t f, size_t l, bool value = true) {
-        for (; f != l; ++f) state[f] = value;
+    // chunks having free runs are listed in available_
+    void update_available(size_type index) {
+        auto& ch = chunks_[index];
+        if (ch.largest != 0 && ch.slot == npos) {
+            ch.slot = available_.size();
+            available_.push_back(index);
+        } else if (ch.largest == 0 && ch.slot != npos)
+            remove_available(ch);
+    }
+
+    void remove_available(chunk& ch) {
+        auto last = available_.back();
+        available_[ch.slot] = last;
+        chunks_[last].slot = ch.slot;
+        available_.pop_back();
+        ch.slot = npos;
+    }
+
+    // removes chunks found saturated by search
+    void prune_available() {
+        for (auto k = available_.size(); k-- != 0;)
+            if (chunks_[available_[k]].largest == 0)
+                remove_available(chunks_[available_[k]]);
+    }
+
+    T* take(size_type index, size_type i, size_type n) {
+        auto& ch = chunks_[index];
+        auto state = ch.state();
+        // only best fit needs exact summary, it keeps it unless the longest run is taken
+        if (ch.exact && (!FitPolicy::best || state.find_one(i) - i >= ch.largest))
+            ch.exact = false;
+        state.set(i, i + n); // set elements are busy
+        acquire(index, n);
+        return &ch.data[i]; // and return pointer on first element
+    }
+
+    T* find_free(size_type n) {
+        // find sequence of n free elements visiting available chunks in order of FitPolicy
+        size_type walked = 0, scanned = 0, best = npos;
+        bool saturated = false; // some chunks are found without free runs
+        auto count = available_.size();
+        for (size_type k = 0; k < count; ++k) {
+            auto slot = FitPolicy::roving ? (cursor_ + k) % count : count - 1 - k;
+            auto& ch = chunks_[available_[slot]];
+            ++walked;
+            if (ch.largest < n)
+                continue;
+
+            if constexpr (FitPolicy::best) {
+                if (!ch.exact) {
+                    ch.largest = ch.state().largest_zero_run();
+                    ch.exact = true;
+                    scanned += ch.capacity;
+                    saturated |= ch.largest == 0;
+                }
+                if (ch.largest < n || (best != npos && ch.largest >= chunks_[best].largest))
+                    continue;
+                best = available_[slot];
+                if (ch.largest == n)
+                    break;
+            } else {
+                auto state = ch.state();
+                auto i = state.find_zero_run(n);
+                if (i == state.npos()) {
+                    scanned += ch.capacity;
+                    ch.largest = n - 1;
+                    ch.exact = false;
+                    saturated |= n == 1;
+                    continue;
+                }
+                if constexpr (FitPolicy::roving)
+                    cursor_ = slot;
+                stats_.on_scan(walked, scanned + i + n);
+                auto index = available_[slot];
+                if (saturated)
+                    prune_available();
+                return take(index, i, n);
+            }
+        }
+
+        if (saturated)
+            prune_available();
+
+        if (best != npos) {
+            auto i = chunks_[best].state().find_best_zero_run(n);
+            stats_.on_scan(walked, scanned + chunks_[best].capacity);
+            return take(best, i, n);
+        }
+
+        stats_.on_scan(walked, scanned);
+        return nullptr;
+    }
+
+    T* allocate_large(size_type n) {
+        if (n > (std::numeric_limits<size_type>::max() - large_offset) / sizeof(T))
+            throw std::bad_alloc();
+
+        auto size = large_offset + n * sizeof(T);
+        auto block = source_.allocate(size, std::max(alignof(T), alignof(large_block)));
+
+        auto p = static_cast<large_block*>(block);
+        p->size = size;
+        p->prev = nullptr;
+        p->next = large_;
+        if (large_ != nullptr)
+            large_->prev = p;
+        large_ = p;
+        return reinterpret_cast<T*>(static_cast<char*>(block) + large_offset);
+    }
+
+    void deallocate_large(T* ptr) {
+        auto p = reinterpret_cast<large_block*>(reinterpret_cast<char*>(ptr) - large_offset);
+        if (p->next != nullptr)
+            p->next->prev = p->prev;
+        (p->prev != nullptr ? p->prev->next : large_) = p->next;
+        source_.deallocate(p, p->size);
+    }
+
+    static T* next_free(T* p) {
+        T* ret;
+        memcpy(&ret, reinterpret_cast<void*>(p), sizeof(ret));
+        return ret;
+    }
+
+    static void set_next_free(T* p, T* next) {
+        memcpy(reinterpret_cast<void*>(p), &next, sizeof(next));
+    }
+
+    void push_free(size_type index, T* p) {
+        auto& ch = chunks_[index];
+        set_next_free(p, ch.free_list);
+        ch.free_list = p;
+        if (ch.listed == npos) {
+            ch.listed = listed_.size();
+            listed_.push_back(index);
+        } else if (ch.listed != listed_.size() - 1) {
+            // the last freed element is popped first
+            auto last = listed_.back();
+            chunks_[last].listed = ch.listed;
+            listed_[ch.listed] = last;
+            ch.listed = listed_.size() - 1;
+            listed_.back() = index;
+        }
+    }
+
+    T* pop_free(size_type index) {
+        auto& ch = chunks_[index];
+        auto ret = ch.free_list;
+        ch.free_list = next_free(ret);
+        if (ch.free_list == nullptr)
+            unlist(ch);
+        return ret;
+    }
+
+    void unlist(chunk& ch) {
+        auto last = listed_.back();
+        listed_[ch.listed] = last;
+        chunks_[last].listed = ch.listed;
+        listed_.pop_back();
+        ch.listed = npos;
+        ch.free_list = nullptr;
+    }
+
+    // elements of free list of chunk are released in its state
+    void flush_chunk(size_type index) {
+        auto& ch = chunks_[index];
+        auto state = ch.state();
+        for (auto p = ch.free_list; p != nullptr; p = next_free(p)) {
+            size_t i = p - ch.data;
+            state.reset(i, i + 1);
+        }
+        unlist(ch);
+        release_run(index);
+    }
+
+    void flush_free_list() {
+        while (!listed_.empty())
+            flush_chunk(listed_.back());
     }
 
 private:
-    chunk* head_ = {nullptr};
+    UpstreamSource source_;
+    size_type chunk_n_;
+    size_type max_chunk_n_;
+    size_type chunk_alignment_;
+    size_type last_chunk_n_ = {0};
+
+    std::vector<chunk> chunks_;
+    std::vector<size_type> available_;
+    size_type cursor_ = {0}; // position in available_ of the last allocation for next fit
+    large_block* large_ = {nullptr};
+    std::vector<size_type> listed_; // chunks having free lists
+    size_type empty_chunks_ = {0};
+
+    Stats stats_;
 };
 
-} // namespace griha
\ No newline at end of file
+template <typename T, size_t ChunkN, typename ReclaimPolicy, typename GrowthPolicy,
+          typename UpstreamSource, typename Stats, typename FitPolicy>
+void swap(allocator_arena<T, ChunkN, ReclaimPolicy, GrowthPolicy, UpstreamSource, Stats, FitPolicy>& lhs,
+          allocator_arena<T, ChunkN, ReclaimPolicy, GrowthPolicy, UpstreamSource, Stats, FitPolicy>& rhs) {
+    lhs.swap(rhs);
+}
+
+} // namespace griha
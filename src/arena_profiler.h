@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <execinfo.h>
+
+#include "arena_stats.h"
+
+namespace griha {
+
+// Tag attributed to allocations sampled by arena_profiler on this thread while scope is alive.
+// Scopes are nested, tag should outlive the scope.
+class arena_profile_scope {
+public:
+    explicit arena_profile_scope(const char* tag) : prev_(current_) { current_ = tag; }
+    ~arena_profile_scope() { current_ = prev_; }
+
+    arena_profile_scope(const arena_profile_scope&) = delete;
+    arena_profile_scope& operator= (const arena_profile_scope&) = delete;
+
+    static const char* current() { return current_; }
+
+private:
+    static inline thread_local const char* current_ = nullptr;
+
+    const char* prev_;
+};
+
+// Sampling heap profiler, Stats policy of allocator_arena.
+// Allocated bytes are sampled at exponentially distributed distances with mean of sample rate,
+// so allocation of n bytes is sampled with probability 1 - exp(-n / rate) and it stands for
+// 1 / probability allocations in estimates. Sampled allocation records stack of its caller
+// (if enabled) and tag of arena_profile_scope, allocations of equal stacks and tags make site.
+// With sampling off (rate 0) allocation costs one untaken branch, deallocation costs one more
+// while there are no live samples.
+class arena_profiler {
+public:
+    struct timestamp {};
+
+    static constexpr bool enabled = false; // no counters for stats_snapshot
+    static constexpr size_t max_frames = 32;
+
+    struct site {
+        std::string tag;
+        std::vector<void*> stack;
+
+        // raw counters of samples
+        uint64_t live_samples = 0;
+        uint64_t live_sampled_bytes = 0;
+        uint64_t total_samples = 0;
+        uint64_t total_sampled_bytes = 0;
+
+        // estimates of all allocations
+        double live_count = 0.;
+        double live_bytes = 0.;
+        double total_count = 0.;
+        double total_bytes = 0.;
+    };
+
+public:
+    explicit arena_profiler(uint64_t sample_rate = 0, bool capture_stacks = true, uint64_t seed = 1)
+        : capture_stacks_(capture_stacks), gen_(seed) {
+        set_sample_rate(sample_rate);
+    }
+
+    // mean distance between samples in bytes, 0 turns sampling off
+    void set_sample_rate(uint64_t rate) {
+        rate_ = rate;
+        bytes_until_sample_ = next_distance();
+    }
+
+    uint64_t sample_rate() const { return rate_; }
+
+    timestamp start() const { return {}; }
+
+    void on_allocate(const void* p, size_t bytes, timestamp) {
+        if (bytes >= bytes_until_sample_)
+            sample(p, bytes);
+        else
+            bytes_until_sample_ -= bytes;
+    }
+
+    void on_allocate_large(const void* p, size_t bytes, timestamp t) { on_allocate(p, bytes, t); }
+
+    // Any run of elements may be deallocated at once (see max_piecewise_size of allocator_arena),
+    // so all samples starting in deallocated range are released.
+    void on_deallocate(const void* p, size_t bytes, timestamp) {
+        if (!live_.empty())
+            release(static_cast<const char*>(p), bytes);
+    }
+
+    void on_scan(size_t /*chunks*/, size_t /*bits*/) {}
+    void on_lookup() {}
+
+    void fill(arena_stats_snapshot&) const {}
+
+    const std::vector<site>& sites() const { return sites_; }
+    size_t live_samples() const { return live_.size(); }
+
+    // drops samples and sites keeping sample rate
+    void reset() {
+        sites_.clear();
+        site_index_.clear();
+        live_.clear();
+    }
+
+    // Legacy heap profile of gperftools (heap_v2) read by pprof, counts are of raw samples
+    // which pprof scales by sample rate itself. Tags are not represented in this format.
+    void dump_pprof(std::ostream& os) const {
+        site totals;
+        for (auto& s : sites_)
+            add_counters(totals, s);
+
+        char line[128];
+        snprintf(line, sizeof(line), "heap profile: %6llu: %8llu [%6llu: %8llu] @ heap_v2/%llu\n",
+                 ull(totals.live_samples), ull(totals.live_sampled_bytes),
+                 ull(totals.total_samples), ull(totals.total_sampled_bytes), ull(rate_));
+        os << line;
+        for (auto& s : sites_) {
+            snprintf(line, sizeof(line), "%6llu: %8llu [%6llu: %8llu] @",
+                     ull(s.live_samples), ull(s.live_sampled_bytes),
+                     ull(s.total_samples), ull(s.total_sampled_bytes));
+            os << line;
+            for (auto f : s.stack) {
+                snprintf(line, sizeof(line), " %p", f);
+                os << line;
+            }
+            os << '\n';
+        }
+
+        os << "\nMAPPED_LIBRARIES:\n";
+        std::ifstream maps("/proc/self/maps");
+        os << maps.rdbuf();
+    }
+
+    // estimated live and total allocations per site in descending order of live bytes
+    void dump_text(std::ostream& os) const {
+        std::vector<const site*> ordered;
+        for (auto& s : sites_)
+            ordered.push_back(&s);
+        std::stable_sort(ordered.begin(), ordered.end(),
+                         [] (auto a, auto b) { return a->live_bytes > b->live_bytes; });
+
+        os << "sample rate " << rate_ << " bytes, " << sites_.size() << " sites\n";
+        for (auto s : ordered) {
+            os << "live " << uint64_t(s->live_bytes) << " bytes in " << uint64_t(s->live_count)
+               << ", total " << uint64_t(s->total_bytes) << " bytes in " << uint64_t(s->total_count)
+               << ", tag " << (s->tag.empty() ? "-" : s->tag) << '\n';
+            if (s->stack.empty())
+                continue;
+            auto symbols = backtrace_symbols(s->stack.data(), int(s->stack.size()));
+            for (size_t i = 0; i < s->stack.size(); ++i)
+                os << "    " << (symbols != nullptr ? symbols[i] : "?") << '\n';
+            free(symbols);
+        }
+    }
+
+private:
+    struct live_sample {
+        size_t site;
+        size_t bytes;
+        double weight;
+    };
+
+    static unsigned long long ull(uint64_t v) { return v; }
+
+    uint64_t next_distance() {
+        if (rate_ == 0)
+            return std::numeric_limits<uint64_t>::max();
+        if (rate_ == 1)
+            return 1; // every allocation is sampled
+        auto d = std::exponential_distribution<double>(1. / double(rate_))(gen_);
+        return std::max(uint64_t(1), static_cast<uint64_t>(std::min(d, 1e18)));
+    }
+
+    __attribute__((noinline)) void sample(const void* p, size_t bytes) {
+        bytes_until_sample_ = next_distance();
+
+        void* frames[max_frames + 1];
+        int depth = capture_stacks_ ? backtrace(frames, int(max_frames + 1)) : 0;
+
+        // frame of this function is skipped
+        auto key = std::make_pair(std::string(arena_profile_scope::current() != nullptr
+                                              ? arena_profile_scope::current() : ""),
+                                  std::vector<void*>(frames + std::min(depth, 1), frames + depth));
+        auto it = site_index_.find(key);
+        if (it == site_index_.end()) {
+            site s;
+            s.tag = key.first;
+            s.stack = key.second;
+            sites_.push_back(std::move(s));
+            it = site_index_.emplace(std::move(key), sites_.size() - 1).first;
+        }
+
+        auto weight = 1. / -std::expm1(-double(bytes) / double(rate_));
+        auto& s = sites_[it->second];
+        ++s.live_samples;
+        s.live_sampled_bytes += bytes;
+        ++s.total_samples;
+        s.total_sampled_bytes += bytes;
+        s.live_count += weight;
+        s.live_bytes += weight * bytes;
+        s.total_count += weight;
+        s.total_bytes += weight * bytes;
+
+        live_[static_cast<const char*>(p)] = {it->second, bytes, weight};
+    }
+
+    void release(const char* p, size_t bytes) {
+        for (auto it = live_.lower_bound(p); it != live_.end() && it->first < p + bytes;) {
+            auto& s = sites_[it->second.site];
+            --s.live_samples;
+            s.live_sampled_bytes -= it->second.bytes;
+            s.live_count -= it->second.weight;
+            s.live_bytes -= it->second.weight * it->second.bytes;
+            it = live_.erase(it);
+        }
+    }
+
+    static void add_counters(site& to, const site& s) {
+        to.live_samples += s.live_samples;
+        to.live_sampled_bytes += s.live_sampled_bytes;
+        to.total_samples += s.total_samples;
+        to.total_sampled_bytes += s.total_sampled_bytes;
+    }
+
+private:
+    uint64_t rate_ = {0};
+    uint64_t bytes_until_sample_;
+    bool capture_stacks_;
+    std::mt19937_64 gen_;
+
+    std::vector<site> sites_;
+    std::map<std::pair<std::string, std::vector<void*>>, size_t> site_index_;
+    std::map<const char*, live_sample> live_; // ordered to release runs of elements
+};
+
+} // namespace griha
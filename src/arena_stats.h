@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace griha {
+
+// Runtime snapshot of arena behaviour.
+// Counters are collected by arena_stats, layout of chunks is computed on taking of snapshot.
+struct arena_stats_snapshot {
+    // log2 buckets of latency in nanoseconds: bucket i counts calls taking [2^(i-1), 2^i) ns
+    using histogram = std::array<uint64_t, 32>;
+
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t large_allocations = 0;
+    uint64_t live_bytes = 0;
+    uint64_t peak_live_bytes = 0;
+
+    uint64_t bits_scanned = 0;        // by search of free sequences in chunk states
+    uint64_t chunks_walked = 0;       // by allocations searching for free sequences
+    uint64_t chunk_lookups = 0;       // by deallocations, every lookup is a single address mask
+
+    size_t chunks = 0;
+    size_t free_slots = 0;
+    size_t largest_free_run = 0;
+
+    histogram allocate_latency = {};
+    histogram deallocate_latency = {};
+
+    double avg_bits_scanned() const { return allocations != 0 ? double(bits_scanned) / allocations : 0.; }
+    double avg_chunks_walked() const { return allocations != 0 ? double(chunks_walked) / allocations : 0.; }
+
+    // 0 if all free slots make a single run, close to 1 if free space is scattered in small holes
+    double fragmentation() const {
+        return free_slots != 0 ? 1. - double(largest_free_run) / free_slots : 0.;
+    }
+};
+
+// Statistics policies of allocator_arena.
+// Arena calls hooks on its hot paths, no_stats makes all of them empty and compiled out.
+
+struct no_stats {
+    struct timestamp {};
+
+    static constexpr bool enabled = false;
+
+    timestamp start() const { return {}; }
+    void on_allocate(const void* /*p*/, size_t /*bytes*/, timestamp) {}
+    void on_allocate_large(const void* /*p*/, size_t /*bytes*/, timestamp) {}
+    void on_deallocate(const void* /*p*/, size_t /*bytes*/, timestamp) {}
+    void on_scan(size_t /*chunks*/, size_t /*bits*/) {}
+    void on_lookup() {}
+
+    void fill(arena_stats_snapshot&) const {}
+};
+
+// counts operations and optionally measures their latency
+template <bool MeasureLatency = true>
+class arena_stats {
+public:
+    using clock = std::chrono::steady_clock;
+    struct timestamp { clock::time_point value; };
+
+    static constexpr bool enabled = true;
+
+public:
+    timestamp start() const {
+        if constexpr (MeasureLatency)
+            return {clock::now()};
+        else
+            return {};
+    }
+
+    void on_allocate(const void* /*p*/, size_t bytes, timestamp t) {
+        ++data_.allocations;
+        data_.live_bytes += bytes;
+        if (data_.live_bytes > data_.peak_live_bytes)
+            data_.peak_live_bytes = data_.live_bytes;
+        record(data_.allocate_latency, t);
+    }
+
+    void on_allocate_large(const void* p, size_t bytes, timestamp t) {
+        ++data_.large_allocations;
+        on_allocate(p, bytes, t);
+    }
+
+    void on_deallocate(const void* /*p*/, size_t bytes, timestamp t) {
+        ++data_.deallocations;
+        data_.live_bytes -= bytes;
+        record(data_.deallocate_latency, t);
+    }
+
+    void on_scan(size_t chunks, size_t bits) {
+        data_.chunks_walked += chunks;
+        data_.bits_scanned += bits;
+    }
+
+    void on_lookup() { ++data_.chunk_lookups; }
+
+    void fill(arena_stats_snapshot& s) const {
+        auto chunks = s.chunks, free_slots = s.free_slots, largest_free_run = s.largest_free_run;
+        s = data_;
+        s.chunks = chunks;
+        s.free_slots = free_slots;
+        s.largest_free_run = largest_free_run;
+    }
+
+private:
+    static void record(arena_stats_snapshot::histogram& h, timestamp t) {
+        if constexpr (MeasureLatency) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t.value).count();
+            size_t bucket = ns > 0 ? 64 - __builtin_clzll(static_cast<uint64_t>(ns)) : 0;
+            ++h[std::min(bucket, h.size() - 1)];
+        }
+    }
+
+private:
+    arena_stats_snapshot data_;
+};
+
+} // namespace griha
@@ -1,9 +1,15 @@
 #pragma once
 
 #include <type_traits>
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <initializer_list>
 #include <iterator>
 #include <memory>
 #include <limits>
+#include <utility>
+#include <cstdint>
 
 namespace griha {
 
@@ -16,15 +22,23 @@ public:
     using const_reference = const T&;
 
 private:
+    struct node;
+
+    // Nodes are linked by pointers of allocator, so fancy pointers (as offset_ptr) let list
+    // live in memory mapped at any address. Algorithms work on raw pointers.
+    using node_pointer = typename std::pointer_traits<
+        typename std::allocator_traits<Alloc>::pointer>::template rebind<node>;
+
     struct node {
         T value;
-        node* prev;
-        node* next;
+        node_pointer prev;
+        node_pointer next;
     };
 
     template <bool Const>
     class iterator_inner {
         template <typename, typename> friend class bidirectional_list;
+        friend class iterator_inner<!Const>;
 
         using list_type = std::conditional_t<!Const, bidirectional_list, const bidirectional_list>;
 
@@ -36,19 +50,18 @@ private:
         using iterator_category = std::bidirectional_iterator_tag;
 
     public:
-        iterator_inner(const iterator_inner& src) : list_(src.list_), n_(src.n_) {}
+        iterator_inner(const iterator_inner&) = default;
+        iterator_inner& operator=(const iterator_inner&) = default;
 
-        iterator_inner& operator=(const iterator_inner& rhs) {
-            n_ = rhs.n_;
-            return *this;
-        }
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        iterator_inner(const iterator_inner<false>& src) : list_(src.list_), n_(src.n_) {}
 
-        reference operator* () { return n_->value; }
-        pointer operator-> () { return n_; }
+        reference operator* () const { return n_->value; }
+        pointer operator-> () const { return &n_->value; }
 
         iterator_inner& operator++ () {
             if (n_ != nullptr)
-                n_ = n_->next;
+                n_ = to_address(n_->next);
             return *this;
         }
 
@@ -59,7 +72,7 @@ private:
         }
 
         iterator_inner& operator-- () {
-            n_ = n_ != nullptr ? n_->prev : list_.tail_;
+            n_ = to_address(n_ != nullptr ? n_->prev : list_->tail_);
             return *this;
         }
 
@@ -70,174 +83,694 @@ private:
         }
 
         friend
-        bool operator== (const iterator_inner<Const>& lhs, const iterator_inner<Const>& rhs) {
+        bool operator== (const iterator_inner& lhs, const iterator_inner& rhs) {
             return lhs.n_ == rhs.n_;
         }
 
-    protected:
-        explicit iterator_inner(list_type& list, node* n) : list_(list), n_(n) {}
+        friend
+        bool operator!= (const iterator_inner& lhs, const iterator_inner& rhs) {
+            return !(lhs == rhs);
+        }
+
+    private:
+        iterator_inner(list_type& list, node* n) : list_(&list), n_(n) {}
 
     private:
-        list_type& list_;
+        list_type* list_;
         node* n_;
     };
 
-    template <bool Const>
-    friend
-    bool operator!= (const iterator_inner<Const>& lhs, const iterator_inner<Const>& rhs) {
-        return !(lhs == rhs);
-    }
-
-    using alloc_type = typename Alloc::template rebind<node>::other;
+    using alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
     using alloc_traits = std::allocator_traits<alloc_type>;
 
 public:
-    class iterator : public iterator_inner<false> {
-        template <typename, typename> friend class bidirectional_list;
-        friend class const_iterator;
-
-        using super = iterator_inner<false>;
-
-    public:
-        using typename super::value_type;
-        using typename super::reference;
-        using typename super::pointer;
-        using typename super::difference_type;
-        using typename super::iterator_category;
-
-    public:
-        iterator(const iterator& src) : super(src) {}
-
-    private:
-        iterator(bidirectional_list& list, node* n = nullptr) : super(list, n) {}
-    };
-
-    class const_iterator : public iterator_inner<true> {
-        template <typename, typename> friend class bidirectional_list;
-
-        using super = iterator_inner<true>;
-
-    public:
-        using typename super::value_type;
-        using typename super::reference;
-        using typename super::pointer;
-        using typename super::difference_type;
-        using typename super::iterator_category;
-
-    public:
-        const_iterator(const const_iterator& src) : super(src) {}
-        const_iterator(const iterator& src) : super(src.list_, src.n_) {}
-
-    private:
-        const_iterator(const bidirectional_list& list, node* n = nullptr) : super(list, n) {}
-    };
+    using iterator = iterator_inner<false>;
+    using const_iterator = iterator_inner<true>;
 
     using pointer = typename std::allocator_traits<Alloc>::pointer;
     using const_pointer = typename std::allocator_traits<Alloc>::const_pointer;
     using difference_type = ptrdiff_t;
     using size_type = size_t;
 
+public:
+    using allocator_type = Alloc;
+
 public:
     bidirectional_list() {}
-    ~bidirectional_list() {
-        for (; head_ != nullptr; head_ = head_->next) {
-            alloc_traits::destroy(alloc_, reinterpret_cast<pointer>(head_));
-            alloc_traits::deallocate(alloc_, head_, 1ul);
-        }
-        tail_ = nullptr;
-    }
+    explicit bidirectional_list(const Alloc& alloc) : alloc_(alloc) {}
+    ~bidirectional_list() { clear(); }
 
-    bidirectional_list(const bidirectional_list& src) {
-        if (src.empty())
-            return;
+    // Allocators are handled as by standard containers according to their propagate_on_container_*
+    // traits. Allocators which can't be copied (as allocator_arena) give new one to copy of list.
 
-        head_ = alloc_traits::allocate(alloc_, src.size());
-        for (auto n = head_, n_src = src.head_;
-             n_src != nullptr;
-             ++n, n_src = n_src->next) {
-                 
-            alloc_traits::construct(alloc_, reinterpret_cast<pointer>(n), n_src->value);
-            n->prev = tail_;
-            n->next = nullptr;
-            if (n->prev != nullptr)
-                n->prev->next = n;
-            tail_ = n;
-        }
+    bidirectional_list(const bidirectional_list& src) : alloc_(copy_allocator(src.alloc_)) {
+        insert(end(), src.begin(), src.end());
     }
 
-    bidirectional_list(bidirectional_list&& src) {
-        swap(src);
-    }
+    // nodes are taken in O(1) together with allocator
+    bidirectional_list(bidirectional_list&& src)
+        : alloc_(std::move(src.alloc_)),
+          head_(std::exchange(src.head_, nullptr)),
+          tail_(std::exchange(src.tail_, nullptr)),
+          size_(std::exchange(src.size_, 0)),
+          defrag_(std::exchange(src.defrag_, nullptr)) {}
 
+    // existing nodes are reused, so the list is left valid but partially assigned on exception
     bidirectional_list& operator= (const bidirectional_list& rhs) {
-        bidirectional_list t(rhs);
-        swap(t);
+        if (&rhs == this)
+            return *this;
+        if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+            if (!equal_allocator(rhs))
+                clear();
+            alloc_ = rhs.alloc_;
+        }
+        assign(rhs.begin(), rhs.end());
         return *this;
     }
 
+    // Nodes are exchanged in O(1) if allocator propagates (then allocators are exchanged too)
+    // or allocators are equal, otherwise elements are moved one by one into nodes of this list.
     bidirectional_list& operator= (bidirectional_list&& rhs) {
-        swap(rhs);
+        if constexpr (!alloc_traits::propagate_on_container_move_assignment::value) {
+            if (!equal_allocator(rhs)) {
+                assign(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+                rhs.clear();
+                return *this;
+            }
+        }
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            using std::swap;
+            swap(alloc_, rhs.alloc_);
+        }
+        std::swap(head_, rhs.head_);
+        std::swap(tail_, rhs.tail_);
+        std::swap(size_, rhs.size_);
+        std::swap(defrag_, rhs.defrag_);
         return *this;
     }
 
-    iterator begin() { return iterator(*this, head_); }
-    const_iterator begin() const { return const_iterator(*this, head_); }
-    const_iterator cbegin() const { return const_iterator(*this, head_); }
+    iterator begin() { return iterator(*this, to_address(head_)); }
+    const_iterator begin() const { return const_iterator(*this, to_address(head_)); }
+    const_iterator cbegin() const { return const_iterator(*this, to_address(head_)); }
 
     iterator end() { return iterator(*this, nullptr); }
     const_iterator end() const { return const_iterator(*this, nullptr); }
     const_iterator cend() const { return const_iterator(*this, nullptr); }
 
-    template <typename... Args>
-    iterator emplace(const_iterator pos, Args... args) {
-        node* nnode = alloc_traits::allocate(alloc_, 1ul);
-        alloc_traits::construct(alloc_, reinterpret_cast<pointer>(nnode),
-                                std::forward<Args>(args)...);
+    reference front() { return head_->value; }
+    const_reference front() const { return head_->value; }
+    reference back() { return tail_->value; }
+    const_reference back() const { return tail_->value; }
 
-        auto& ref_from_r = pos.n_ != nullptr ? pos.n_->prev : tail_;
-        auto& ref_from_l = ref_from_r != nullptr ? ref_from_r->next : head_;
+    // New node is placed next to its predecessor if allocator takes hints (see locality_alloc).
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        auto neighbor = pos.n_ == nullptr ? to_address(tail_)
+                        : pos.n_->prev != nullptr ? to_address(pos.n_->prev) : pos.n_;
+        node* nnode = allocate_near(1ul, neighbor);
+        try {
+            alloc_traits::construct(alloc_, reinterpret_cast<T*>(nnode),
+                                    std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate_nodes(nnode, 1ul);
+            throw;
+        }
 
-        nnode->next = pos.n_;
-        nnode->prev = ref_from_r;
-        ref_from_r = ref_from_l = nnode;
+        link(pos.n_, nnode, nnode);
         ++size_;
 
         return iterator(*this, nnode);
     }
 
+    template <typename... Args>
+    reference emplace_back(Args&&... args) { return *emplace(end(), std::forward<Args>(args)...); }
+
+    template <typename... Args>
+    reference emplace_front(Args&&... args) { return *emplace(begin(), std::forward<Args>(args)...); }
+
+    iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+
+    void push_back(const T& value) { emplace(end(), value); }
+    void push_back(T&& value) { emplace(end(), std::move(value)); }
+    void push_front(const T& value) { emplace(begin(), value); }
+    void push_front(T&& value) { emplace(begin(), std::move(value)); }
+
+    void pop_back() { erase_node(to_address(tail_)); }
+    void pop_front() { erase_node(to_address(head_)); }
+
     void erase(const_iterator pos) {
         if (pos.n_ == nullptr)
             return;
+        erase_node(pos.n_);
+    }
 
-        auto& ref_from_r = pos.n_->next != nullptr ? pos.n_->next->prev : tail_;
-        auto& ref_from_l = pos.n_->prev != nullptr ? pos.n_->prev->next : head_;
-        
-        ref_from_r = pos.n_->prev;
-        ref_from_l = pos.n_->next;
-        pos.n_->prev = pos.n_->next = nullptr;
-        --size_;
+    // Inserts copies of [first, last) before pos and returns iterator to the first of them.
+    // Nodes are allocated in batches if allocator takes them back piecewise (see piecewise_alloc),
+    // new nodes are linked only after all of them are constructed.
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    iterator insert(const_iterator pos, InputIt first, InputIt last) {
+        auto remaining = std::numeric_limits<size_type>::max();
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                        typename std::iterator_traits<InputIt>::iterator_category>)
+            remaining = static_cast<size_type>(std::distance(first, last));
+
+        node* head = nullptr;
+        node* tail = nullptr;
+        size_type n = 0;
+        while (first != last) {
+            auto batch = std::min(remaining, max_batch_size());
+            node* nodes = to_address(alloc_traits::allocate(alloc_, batch));
+            size_type i = 0;
+            for (; i < batch && first != last; ++i, ++first) {
+                try {
+                    alloc_traits::construct(alloc_, reinterpret_cast<T*>(nodes + i), *first);
+                } catch (...) {
+                    deallocate_nodes(nodes + i, batch - i);
+                    free_chain(head);
+                    throw;
+                }
+                nodes[i].prev = to_pointer(tail);
+                nodes[i].next = nullptr;
+                if (tail != nullptr)
+                    tail->next = to_pointer(nodes + i);
+                else
+                    head = nodes + i;
+                tail = nodes + i;
+            }
+            if (i < batch)
+                deallocate_nodes(nodes + i, batch - i); // input range is exhausted
+            n += i;
+            remaining -= i;
+        }
+
+        if (head == nullptr)
+            return iterator(*this, pos.n_);
+        link(pos.n_, head, tail);
+        size_ += n;
+        return iterator(*this, head);
+    }
+
+    iterator insert(const_iterator pos, std::initializer_list<T> values) {
+        return insert(pos, values.begin(), values.end());
+    }
+
+    // Values are assigned to existing elements in place, so their nodes (and resources
+    // of values like capacity of strings) are reused. Only surplus of range is allocated.
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void assign(InputIt first, InputIt last) {
+        auto n = to_address(head_);
+        for (; n != nullptr && first != last; n = to_address(n->next), ++first)
+            n->value = *first;
+        if (n != nullptr)
+            erase_tail(n);
+        else
+            insert(end(), first, last);
+    }
+
+    void assign(size_type count, const T& value) {
+        auto n = to_address(head_);
+        for (; n != nullptr && count != 0; n = to_address(n->next), --count)
+            n->value = value;
+        if (n != nullptr)
+            erase_tail(n);
+        for (; count != 0; --count)
+            emplace(end(), value);
+    }
+
+    void assign(std::initializer_list<T> values) { assign(values.begin(), values.end()); }
+
+    // Appends count elements of trivially copyable T whose values are written by fill in place,
+    // as by read of binary data. Nodes are allocated in batches next to each other and fill gets
+    // addresses of their values by groups of at most fill_group as (T* const* values, size_type n).
+    // New nodes are linked after they are filled. If fill throws, groups filled before are appended
+    // and the rest of nodes is freed.
+    static constexpr size_type fill_group = 1024;
+
+    template <typename Fill>
+    void append_uninitialized(size_type count, Fill fill) {
+        static_assert(std::is_trivially_copyable_v<T>, "values are written as bytes");
+
+        node* head = nullptr;
+        node* tail = nullptr;
+        node* filled = nullptr; // the last node of filled groups
+        size_type filled_n = 0;
+        T* values[fill_group];
+        size_type grouped = 0;
+        try {
+            for (size_type n = 0; n < count;) {
+                auto batch = std::min(count - n, max_batch_size());
+                node* nodes = allocate_near(batch, tail);
+                // the whole batch joins the chain at once, so nodes are freed with it
+                for (size_type i = 0; i < batch; ++i) {
+                    nodes[i].prev = to_pointer(tail);
+                    nodes[i].next = nullptr;
+                    if (tail != nullptr)
+                        tail->next = to_pointer(nodes + i);
+                    else
+                        head = nodes + i;
+                    tail = nodes + i;
+                }
+                for (size_type i = 0; i < batch; ++i) {
+                    values[grouped++] = reinterpret_cast<T*>(nodes + i);
+                    if (grouped == fill_group || n + i + 1 == count) {
+                        fill(static_cast<T* const*>(values), grouped);
+                        filled = nodes + i;
+                        filled_n += grouped;
+                        grouped = 0;
+                    }
+                }
+                n += batch;
+            }
+        } catch (...) {
+            auto rest = filled != nullptr ? to_address(filled->next) : head;
+            if (filled != nullptr) {
+                filled->next = nullptr;
+                link(nullptr, head, filled);
+                size_ += filled_n;
+            }
+            free_chain(rest);
+            throw;
+        }
+
+        if (head == nullptr)
+            return;
+        link(nullptr, head, tail);
+        size_ += count;
+    }
+
+    void clear() {
+        free_chain(to_address(head_));
+        head_ = tail_ = nullptr;
+        size_ = 0;
+        defrag_ = nullptr;
+    }
+
+    // Relocates nodes into list order, so traversal walks memory sequentially: every node
+    // not following its predecessor in memory is moved into run of adjacent free nodes
+    // allocated next to the predecessor. It is incremental, at most max_nodes nodes are visited
+    // per call and the next call resumes where this one stopped. Returns true when the pass
+    // reached the end of list, the next call starts new pass from the head.
+    // Iterators and references to relocated elements are invalidated. Elements are moved
+    // if it doesn't throw, otherwise copied, element is left in its node on exception.
+    bool defragment(size_type max_nodes) {
+        static_assert(locality_alloc<alloc_type>::value, "allocator should provide allocate_near");
+
+        auto c = to_address(defrag_ != nullptr ? defrag_ : head_);
+        // destination runs are of batch length but not longer than remaining nodes of the call,
+        // so the next call likely finds free nodes next to the last relocated one
+        node* run = nullptr;
+        size_type run_n = 0, used = 0;
+        for (; c != nullptr && c->next != nullptr && max_nodes != 0; --max_nodes) {
+            auto n = to_address(c->next);
+            if (n == c + 1) {
+                c = n;
+                continue;
+            }
+            if (used == run_n) {
+                run_n = std::min(max_batch_size(), max_nodes);
+                run = allocate_near(run_n, c);
+                used = 0;
+            }
+            auto p = run + used;
+            try {
+                alloc_traits::construct(alloc_, reinterpret_cast<T*>(p), std::move_if_noexcept(n->value));
+            } catch (...) {
+                deallocate_nodes(p, run_n - used);
+                defrag_ = to_pointer(c);
+                throw;
+            }
+            ++used;
+            p->prev = to_pointer(c);
+            p->next = n->next;
+            c->next = to_pointer(p);
+            (n->next != nullptr ? n->next->prev : tail_) = to_pointer(p);
+            alloc_traits::destroy(alloc_, reinterpret_cast<T*>(n));
+            deallocate_nodes(n, 1ul);
+            c = p;
+        }
+        if (used != run_n)
+            deallocate_nodes(run + used, run_n - used);
+
+        auto done = c == nullptr || c->next == nullptr;
+        defrag_ = to_pointer(done ? nullptr : c);
+        return done;
+    }
+
+    // Operations below relink nodes and never allocate.
+    // Nodes are moved between lists, so allocators of lists should compare equal.
+
+    // moves all elements of other before pos
+    void splice(const_iterator pos, bidirectional_list& other) {
+        assert(alloc_ == other.alloc_);
+        if (&other == this || other.empty())
+            return;
+        auto first = to_address(other.head_), last = to_address(other.tail_);
+        other.unlink(first, last);
+        link(pos.n_, first, last);
+        size_ += other.size_;
+        other.size_ = 0;
+    }
 
-        alloc_traits::destroy(alloc_, reinterpret_cast<pointer>(pos.n_));
-        alloc_traits::deallocate(alloc_, pos.n_, 1ul);
+    void splice(const_iterator pos, bidirectional_list&& other) { splice(pos, other); }
+
+    // moves element it of other before pos
+    void splice(const_iterator pos, bidirectional_list& other, const_iterator it) {
+        assert(alloc_ == other.alloc_);
+        if (it.n_ == nullptr || it.n_ == pos.n_)
+            return;
+        other.unlink(it.n_, it.n_);
+        link(pos.n_, it.n_, it.n_);
+        ++size_;
+        --other.size_;
     }
 
+    // moves elements [first, last) of other before pos, it costs length of range for other list
+    void splice(const_iterator pos, bidirectional_list& other, const_iterator first, const_iterator last) {
+        assert(alloc_ == other.alloc_);
+        if (first == last)
+            return;
+        auto l = to_address(last.n_ != nullptr ? last.n_->prev : other.tail_);
+        if (&other != this) {
+            size_type n = 1;
+            for (auto p = first.n_; p != l; p = to_address(p->next), ++n);
+            size_ += n;
+            other.size_ -= n;
+        }
+        other.unlink(first.n_, l);
+        link(pos.n_, first.n_, l);
+    }
+
+    // merges sorted other into this sorted list, equal elements of this list precede ones of other
+    // nodes are moved one by one, so both lists stay valid if comparison throws
+    template <typename Compare>
+    void merge(bidirectional_list& other, Compare comp) {
+        assert(alloc_ == other.alloc_);
+        if (&other == this)
+            return;
+
+        auto a = to_address(head_);
+        for (auto b = to_address(other.head_); b != nullptr;) {
+            if (a == nullptr) {
+                splice(end(), other);
+                break;
+            }
+            if (comp(b->value, a->value)) {
+                auto next = to_address(b->next);
+                other.unlink(b, b);
+                --other.size_;
+                link(a, b, b);
+                ++size_;
+                b = next;
+            } else
+                a = to_address(a->next);
+        }
+        other.defrag_ = nullptr;
+    }
+
+    void merge(bidirectional_list& other) { merge(other, std::less<>()); }
+    void merge(bidirectional_list&& other) { merge(other, std::less<>()); }
+
+    // stable merge sort, O(n log n) comparisons
+    // if comparison throws, all elements are kept in the list in unspecified order
+    template <typename Compare>
+    void sort(Compare comp) {
+        if (size_ < 2)
+            return;
+
+        // bottom-up merge of sorted runs, runs[i] holds 2^i nodes, every node stays reachable
+        // from runs, run or rest
+        node* runs[std::numeric_limits<size_type>::digits] = {};
+        node* run = nullptr;
+        auto rest = to_address(head_);
+        try {
+            while (rest != nullptr) {
+                run = rest;
+                rest = to_address(rest->next);
+                run->next = nullptr;
+                size_type i = 0;
+                for (; runs[i] != nullptr; ++i)
+                    merge_chains(runs[i], run, comp);
+                runs[i] = run;
+                run = nullptr;
+            }
+            for (auto& r : runs) {
+                if (r != nullptr)
+                    merge_chains(r, run, comp);
+            }
+        } catch (...) {
+            for (auto r : runs)
+                run = concat_chains(r, run);
+            relink_chain(concat_chains(run, rest));
+            throw;
+        }
+        relink_chain(run);
+    }
+
+    void sort() { sort(std::less<>()); }
+
+    void reverse() {
+        for (auto n = to_address(head_); n != nullptr; n = to_address(n->prev))
+            std::swap(n->prev, n->next);
+        std::swap(head_, tail_);
+    }
+
+    // removes all but the first element of every group of consecutive equal elements,
+    // returns number of removed elements
+    template <typename BinaryPredicate>
+    size_type unique(BinaryPredicate pred) {
+        size_type ret = 0;
+        for (auto n = to_address(head_); n != nullptr && n->next != nullptr;) {
+            if (pred(n->value, n->next->value)) {
+                erase_node(to_address(n->next));
+                ++ret;
+            } else
+                n = to_address(n->next);
+        }
+        return ret;
+    }
+
+    size_type unique() { return unique(std::equal_to<>()); }
+
+    template <typename Predicate>
+    size_type remove_if(Predicate pred) {
+        size_type ret = 0;
+        for (auto n = to_address(head_); n != nullptr;) {
+            auto next = to_address(n->next);
+            if (pred(n->value)) {
+                erase_node(n);
+                ++ret;
+            }
+            n = next;
+        }
+        return ret;
+    }
+
+    size_type remove(const T& value) {
+        return remove_if([&value] (const T& v) { return v == value; });
+    }
+
+    allocator_type get_allocator() const { return allocator_type(alloc_); }
+
     size_type size() const { return size_; }
     size_type max_size() const { return std::numeric_limits<size_type>::max(); }
 
     bool empty() const { return head_ == nullptr; }
 
+    // allocators are swapped if they propagate on swap, otherwise they should be equal
     void swap(bidirectional_list& other) {
-        std::swap(alloc_, other.alloc_);
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        }
         std::swap(head_, other.head_);
         std::swap(tail_, other.tail_);
         std::swap(size_, other.size_);
+        std::swap(defrag_, other.defrag_);
+    }
+
+private:
+    // Allocators declaring max_piecewise_size() take back any run of adjacent allocated elements
+    // up to that size, so nodes are allocated in batches and freed by runs of adjacent nodes.
+    // Other allocators get every node allocated and freed on its own.
+    template <typename A, typename = void>
+    struct piecewise_alloc : std::false_type {};
+
+    template <typename A>
+    struct piecewise_alloc<A, std::void_t<decltype(std::declval<const A&>().max_piecewise_size())>>
+        : std::true_type {};
+
+    // Allocators declaring allocate_near(n, hint) place nodes close to given node on request.
+    template <typename A, typename = void>
+    struct locality_alloc : std::false_type {};
+
+    template <typename A>
+    struct locality_alloc<A, std::void_t<decltype(std::declval<A&>().allocate_near(
+        size_type(1), std::declval<const typename A::value_type*>()))>> : std::true_type {};
+
+    static constexpr size_type max_batch_n = 64;
+
+    static alloc_type copy_allocator(const alloc_type& src) {
+        if constexpr (std::is_copy_constructible_v<alloc_type>)
+            return alloc_traits::select_on_container_copy_construction(src);
+        else
+            return alloc_type();
+    }
+
+    bool equal_allocator(const bidirectional_list& other) const {
+        if constexpr (alloc_traits::is_always_equal::value)
+            return true;
+        else
+            return alloc_ == other.alloc_;
+    }
+
+    size_type max_batch_size() const {
+        if constexpr (piecewise_alloc<alloc_type>::value)
+            return std::max(std::min(max_batch_n, size_type(alloc_.max_piecewise_size())), size_type(1));
+        else
+            return 1;
+    }
+
+    static node* to_address(const node_pointer& p) {
+        if constexpr (std::is_pointer_v<node_pointer>)
+            return p;
+        else
+            return p != nullptr ? std::addressof(*p) : nullptr;
+    }
+
+    static node_pointer to_pointer(node* p) {
+        if constexpr (std::is_pointer_v<node_pointer>)
+            return p;
+        else
+            return p != nullptr ? std::pointer_traits<node_pointer>::pointer_to(*p) : node_pointer(nullptr);
+    }
+
+    node* allocate_near(size_type n, const node* hint) {
+        if constexpr (locality_alloc<alloc_type>::value)
+            return to_address(alloc_.allocate_near(n, hint));
+        else
+            return to_address(alloc_traits::allocate(alloc_, n));
+    }
+
+    void deallocate_nodes(node* p, size_type n) { alloc_traits::deallocate(alloc_, to_pointer(p), n); }
+
+    // destroys chain of nodes linked forward, returns their number
+    size_type free_chain(node* n) {
+        auto max_run = max_batch_size();
+        size_type ret = 0;
+        while (n != nullptr) {
+            auto first = n;
+            size_type count = 0;
+            do {
+                auto next = to_address(n->next);
+                alloc_traits::destroy(alloc_, reinterpret_cast<T*>(n));
+                ++count;
+                n = next;
+            } while (count < max_run &&
+                     reinterpret_cast<uintptr_t>(n) == reinterpret_cast<uintptr_t>(first) + count * sizeof(node));
+            deallocate_nodes(first, count);
+            ret += count;
+        }
+        return ret;
+    }
+
+    // erases nodes from n to the end of list
+    void erase_tail(node* n) {
+        unlink(n, to_address(tail_));
+        size_ -= free_chain(n);
+    }
+
+    void erase_node(node* n) {
+        unlink(n, n);
+        n->prev = n->next = nullptr;
+        --size_;
+
+        alloc_traits::destroy(alloc_, reinterpret_cast<T*>(n));
+        deallocate_nodes(n, 1ul);
+    }
+
+    // detaches chain of nodes [first, last], position of defragmentation is kept
+    // if it isn't in the chain, it is checked for single node only
+    void unlink(node* first, node* last) {
+        if (defrag_ != nullptr && (first != last || to_address(defrag_) == first))
+            defrag_ = first == last ? first->prev : nullptr;
+
+        auto& ref_from_r = last->next != nullptr ? last->next->prev : tail_;
+        auto& ref_from_l = first->prev != nullptr ? first->prev->next : head_;
+
+        ref_from_r = first->prev;
+        ref_from_l = last->next;
+    }
+
+    // attaches chain of nodes [first, last] before pos
+    void link(node* pos, node* first, node* last) {
+        auto& ref_from_r = pos != nullptr ? pos->prev : tail_;
+        auto& ref_from_l = ref_from_r != nullptr ? ref_from_r->next : head_;
+
+        first->prev = ref_from_r;
+        last->next = to_pointer(pos);
+        ref_from_l = to_pointer(first);
+        ref_from_r = to_pointer(last);
+    }
+
+    // makes chain linked forward only the list, backward links are restored at once
+    void relink_chain(node* head) {
+        head_ = to_pointer(head);
+        node* prev = nullptr;
+        for (auto n = head; n != nullptr; prev = n, n = to_address(n->next))
+            n->prev = to_pointer(prev);
+        tail_ = to_pointer(prev);
+    }
+
+    // joins chains linked forward only
+    static node* concat_chains(node* first, node* second) {
+        if (first == nullptr)
+            return second;
+        auto n = first;
+        while (n->next != nullptr)
+            n = to_address(n->next);
+        n->next = to_pointer(second);
+        return first;
+    }
+
+    // merges sorted chain first into sorted chain second, nodes of first precede equal ones of second
+    // chains are linked forward only, all nodes are left in second even if comparison throws
+    template <typename Compare>
+    static void merge_chains(node*& first, node*& second, Compare& comp) {
+        node* ret = nullptr;
+        node* tail = nullptr;
+        auto append = [&ret, &tail] (node* n) {
+            if (tail != nullptr)
+                tail->next = to_pointer(n);
+            else
+                ret = n;
+            tail = n;
+        };
+        try {
+            while (first != nullptr && second != nullptr) {
+                auto& from = comp(second->value, first->value) ? second : first;
+                auto n = from;
+                from = to_address(from->next);
+                append(n);
+            }
+        } catch (...) {
+            if (tail != nullptr)
+                tail->next = nullptr;
+            second = concat_chains(concat_chains(ret, first), second);
+            first = nullptr;
+            throw;
+        }
+        append(first != nullptr ? first : second);
+        second = ret;
+        first = nullptr;
     }
 
 private:
     alloc_type alloc_;
-    node* head_ = {nullptr};
-    node* tail_ = {nullptr};
+    node_pointer head_ = {nullptr};
+    node_pointer tail_ = {nullptr};
     size_type size_ = {0};
+    node_pointer defrag_ = {nullptr}; // the last visited node of defragmentation pass
 };
 
 template <typename T, typename Alloc>
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace griha {
+
+// Unsigned integer of arbitrary precision, little-endian vector of 32-bit limbs without
+// leading zero limbs (zero has no limbs). Operands of at least karatsuba_threshold limbs
+// are multiplied by Karatsuba's method, smaller ones by schoolbook method.
+class big_uint {
+public:
+    using limb = uint32_t;
+
+    static constexpr size_t karatsuba_threshold = 32;
+
+public:
+    big_uint() = default;
+
+    big_uint(uint64_t v) {
+        for (; v != 0; v >>= 32)
+            limbs_.push_back(static_cast<limb>(v));
+    }
+
+    const std::vector<limb>& limbs() const { return limbs_; }
+
+    bool is_zero() const { return limbs_.empty(); }
+
+    size_t bit_length() const {
+        return limbs_.empty() ? 0 : limbs_.size() * 32 - __builtin_clz(limbs_.back());
+    }
+
+    big_uint& operator+= (const big_uint& rhs) {
+        if (limbs_.size() < rhs.limbs_.size())
+            limbs_.resize(rhs.limbs_.size(), 0);
+        add_into(limbs_, 0, rhs.limbs_.data(), rhs.limbs_.size());
+        return *this;
+    }
+
+    big_uint& operator*= (limb m) {
+        uint64_t carry = 0;
+        for (auto& l : limbs_) {
+            auto t = uint64_t(l) * m + carry;
+            l = static_cast<limb>(t);
+            carry = t >> 32;
+        }
+        if (carry != 0)
+            limbs_.push_back(static_cast<limb>(carry));
+        if (m == 0)
+            limbs_.clear();
+        return *this;
+    }
+
+    big_uint& operator<<= (size_t bits) {
+        if (is_zero())
+            return *this;
+        auto shift = bits % 32;
+        if (shift != 0) {
+            limb carry = 0;
+            for (auto& l : limbs_) {
+                auto t = l;
+                l = (t << shift) | carry;
+                carry = t >> (32 - shift);
+            }
+            if (carry != 0)
+                limbs_.push_back(carry);
+        }
+        limbs_.insert(limbs_.begin(), bits / 32, 0);
+        return *this;
+    }
+
+    friend big_uint operator+ (big_uint lhs, const big_uint& rhs) { return lhs += rhs; }
+
+    friend big_uint operator* (const big_uint& lhs, const big_uint& rhs) {
+        big_uint ret;
+        ret.limbs_ = multiply(lhs.limbs_.data(), lhs.limbs_.size(), rhs.limbs_.data(), rhs.limbs_.size());
+        return ret;
+    }
+
+    // schoolbook multiplication regardless of operand sizes, a baseline for benchmarks
+    friend big_uint multiply_schoolbook(const big_uint& lhs, const big_uint& rhs) {
+        big_uint ret;
+        ret.limbs_.assign(lhs.limbs_.size() + rhs.limbs_.size(), 0);
+        mul_basecase(lhs.limbs_.data(), lhs.limbs_.size(), rhs.limbs_.data(), rhs.limbs_.size(),
+                     ret.limbs_.data());
+        trim(ret.limbs_);
+        return ret;
+    }
+
+    big_uint& operator*= (const big_uint& rhs) { return *this = *this * rhs; }
+
+    friend bool operator== (const big_uint& lhs, const big_uint& rhs) { return lhs.limbs_ == rhs.limbs_; }
+    friend bool operator!= (const big_uint& lhs, const big_uint& rhs) { return !(lhs == rhs); }
+
+    friend bool operator< (const big_uint& lhs, const big_uint& rhs) {
+        if (lhs.limbs_.size() != rhs.limbs_.size())
+            return lhs.limbs_.size() < rhs.limbs_.size();
+        return std::lexicographical_compare(lhs.limbs_.rbegin(), lhs.limbs_.rend(),
+                                            rhs.limbs_.rbegin(), rhs.limbs_.rend());
+    }
+
+    // decimal representation, quadratic in number of limbs
+    std::string to_string() const {
+        if (is_zero())
+            return "0";
+
+        constexpr limb base = 1000000000; // 9 digits per division
+        std::vector<limb> n = limbs_;
+        std::string ret;
+        while (!n.empty()) {
+            uint64_t rem = 0;
+            for (auto i = n.size(); i-- != 0;) {
+                auto cur = (rem << 32) | n[i];
+                n[i] = static_cast<limb>(cur / base);
+                rem = cur % base;
+            }
+            trim(n);
+            for (int d = 0; d < 9 && (!n.empty() || rem != 0); ++d, rem /= 10)
+                ret.push_back(char('0' + rem % 10));
+        }
+        std::reverse(ret.begin(), ret.end());
+        return ret;
+    }
+
+private:
+    static void trim(std::vector<limb>& v) {
+        while (!v.empty() && v.back() == 0)
+            v.pop_back();
+    }
+
+    // out[0, an + bn) = a * b, out should be zeroed
+    static void mul_basecase(const limb* a, size_t an, const limb* b, size_t bn, limb* out) {
+        for (size_t i = 0; i < an; ++i) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < bn; ++j) {
+                auto t = uint64_t(a[i]) * b[j] + out[i + j] + carry;
+                out[i + j] = static_cast<limb>(t);
+                carry = t >> 32;
+            }
+            out[i + bn] = static_cast<limb>(carry);
+        }
+    }
+
+    // adds b to v starting at limb offset, v should be long enough for the sum
+    static void add_into(std::vector<limb>& v, size_t offset, const limb* b, size_t bn) {
+        uint64_t carry = 0;
+        size_t i = 0;
+        for (; i < bn; ++i) {
+            auto t = uint64_t(v[offset + i]) + b[i] + carry;
+            v[offset + i] = static_cast<limb>(t);
+            carry = t >> 32;
+        }
+        for (; carry != 0; ++i) {
+            if (offset + i == v.size())
+                v.push_back(0);
+            auto t = uint64_t(v[offset + i]) + carry;
+            v[offset + i] = static_cast<limb>(t);
+            carry = t >> 32;
+        }
+    }
+
+    // v -= b, v should not be less than b
+    static void sub_from(std::vector<limb>& v, const std::vector<limb>& b) {
+        int64_t borrow = 0;
+        for (size_t i = 0; i < v.size() && (i < b.size() || borrow != 0); ++i) {
+            auto t = int64_t(v[i]) - (i < b.size() ? int64_t(b[i]) : 0) - borrow;
+            borrow = t < 0;
+            v[i] = static_cast<limb>(t + (borrow << 32));
+        }
+        trim(v);
+    }
+
+    static std::vector<limb> sum(const limb* a, size_t an, const limb* b, size_t bn) {
+        if (an < bn) {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+        std::vector<limb> ret(a, a + an);
+        add_into(ret, 0, b, bn);
+        return ret;
+    }
+
+    static std::vector<limb> multiply(const limb* a, size_t an, const limb* b, size_t bn) {
+        if (an < bn) {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+        std::vector<limb> ret;
+        if (bn == 0)
+            return ret;
+
+        ret.assign(an + bn, 0);
+        if (bn < karatsuba_threshold) {
+            mul_basecase(a, an, b, bn, ret.data());
+        } else if (an >= 2 * bn) {
+            // unbalanced operands, longer one is multiplied by pieces of length of shorter one
+            for (size_t i = 0; i < an; i += bn) {
+                auto p = multiply(a + i, std::min(bn, an - i), b, bn);
+                add_into(ret, i, p.data(), p.size());
+            }
+        } else {
+            // a * b = z2 * B^2m + z1 * B^m + z0, z1 = (a0 + a1)(b0 + b1) - z0 - z2
+            auto m = an / 2;
+            auto z0 = multiply(a, m, b, m);
+            auto z2 = multiply(a + m, an - m, b + m, bn - m);
+            auto sa = sum(a, m, a + m, an - m);
+            auto sb = sum(b, m, b + m, bn - m);
+            auto z1 = multiply(sa.data(), sa.size(), sb.data(), sb.size());
+            trim(z0);
+            trim(z2);
+            trim(z1);
+            sub_from(z1, z0);
+            sub_from(z1, z2);
+            add_into(ret, 0, z0.data(), z0.size());
+            add_into(ret, m, z1.data(), z1.size());
+            add_into(ret, 2 * m, z2.data(), z2.size());
+        }
+        trim(ret);
+        return ret;
+    }
+
+private:
+    std::vector<limb> limbs_;
+};
+
+} // namespace griha
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace griha {
+
+namespace bits {
+
+using word_type = std::uint64_t;
+
+constexpr size_t word_bits = 64;
+constexpr word_type all_ones = ~word_type(0);
+
+constexpr size_t words_for(size_t nbits) { return (nbits + word_bits - 1) / word_bits; }
+
+constexpr size_t ceil_pow2(size_t v) {
+    size_t ret = 1;
+    for (; ret < v; ret <<= 1);
+    return ret;
+}
+
+inline size_t ctz(word_type w) { return static_cast<size_t>(__builtin_ctzll(w)); }
+inline size_t popcount(word_type w) { return static_cast<size_t>(__builtin_popcountll(w)); }
+
+// mask with bits [f, l) set, 0 <= f < l <= word_bits
+inline word_type range_mask(size_t f, size_t l) {
+    auto hi = l == word_bits ? all_ones : (word_type(1) << l) - 1;
+    return hi & (all_ones << f);
+}
+
+// skips words equal to pattern starting from word wi, returns index of first differing word or last
+inline size_t skip_words(const word_type* words, size_t wi, size_t last, word_type pattern) {
+#if defined(__SSE2__)
+    // long runs of busy or free space are skipped two words per step
+    const auto p = _mm_set1_epi64x(static_cast<long long>(pattern));
+    for (; wi + 2 <= last; wi += 2) {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + wi));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(v, p)) != 0xFFFF)
+            break;
+    }
+#endif
+    for (; wi < last && words[wi] == pattern; ++wi);
+    return wi;
+}
+
+// position of first bit equal to Value in [pos, last) or last if there is no such bit
+template <bool Value>
+size_t find_bit(const word_type* words, size_t pos, size_t last) {
+    if (pos >= last)
+        return last;
+
+    const auto invert = Value ? word_type(0) : all_ones;
+    auto wi = pos / word_bits;
+    auto w = (words[wi] ^ invert) & (all_ones << (pos % word_bits));
+    if (w == 0) {
+        wi = skip_words(words, wi + 1, words_for(last), invert);
+        if (wi == words_for(last))
+            return last;
+        w = words[wi] ^ invert;
+    }
+    return std::min(wi * word_bits + ctz(w), last);
+}
+
+// position of first sequence of n zero bits in [pos, last) or last if there is no such sequence
+inline size_t find_zero_run(const word_type* words, size_t n, size_t pos, size_t last) {
+    for (pos = find_bit<false>(words, pos, last);
+         pos + n <= last;
+         pos = find_bit<false>(words, pos, last)) {
+        auto busy = find_bit<true>(words, pos, pos + n);
+        if (busy == pos + n)
+            return pos;
+        pos = busy;
+    }
+    return last;
+}
+
+// sets bits [f, l) into Value
+template <bool Value>
+void assign(word_type* words, size_t f, size_t l) {
+    if (f >= l)
+        return;
+
+    auto fw = f / word_bits, lw = (l - 1) / word_bits;
+    auto apply = [words] (size_t wi, word_type mask) {
+        if (Value) words[wi] |= mask;
+        else words[wi] &= ~mask;
+    };
+
+    if (fw == lw) {
+        apply(fw, range_mask(f % word_bits, (l - 1) % word_bits + 1));
+        return;
+    }
+    apply(fw, range_mask(f % word_bits, word_bits));
+    std::fill(words + fw + 1, words + lw, Value ? all_ones : word_type(0));
+    apply(lw, range_mask(0, (l - 1) % word_bits + 1));
+}
+
+// length of the longest sequence of zero bits in [0, last)
+inline size_t largest_zero_run(const word_type* words, size_t last) {
+    size_t ret = 0;
+    for (auto pos = find_bit<false>(words, 0, last); pos < last;) {
+        auto busy = find_bit<true>(words, pos, last);
+        ret = std::max(ret, busy - pos);
+        pos = find_bit<false>(words, busy, last);
+    }
+    return ret;
+}
+
+// position of the shortest sequence of at least n zero bits in [0, last) or last if there is no such sequence
+inline size_t find_best_zero_run(const word_type* words, size_t n, size_t last) {
+    size_t ret = last, len = std::numeric_limits<size_t>::max();
+    for (auto pos = find_bit<false>(words, 0, last); pos < last;) {
+        auto busy = find_bit<true>(words, pos, last);
+        if (busy - pos >= n && busy - pos < len) {
+            ret = pos;
+            len = busy - pos;
+            if (len == n)
+                break;
+        }
+        pos = find_bit<false>(words, busy, last);
+    }
+    return ret;
+}
+
+inline size_t count(const word_type* words, size_t nwords) {
+    size_t ret = 0;
+    for (size_t i = 0; i < nwords; ++i)
+        ret += popcount(words[i]);
+    return ret;
+}
+
+} // namespace bits
+
+// Fixed-size bitmap with word-at-a-time search.
+// In contrast to std::bitset it provides search of zero-bit runs
+// and range modification which cost scales with number of words not bits.
+template <size_t N>
+class bitmap {
+public:
+    static constexpr size_t npos = N;
+
+public:
+    constexpr size_t size() const { return N; }
+
+    bool test(size_t pos) const {
+        return (words_[pos / bits::word_bits] >> (pos % bits::word_bits)) & 1u;
+    }
+
+    size_t find_zero(size_t pos = 0ul) const {
+        return bits::find_bit<false>(words_.data(), pos, N);
+    }
+
+    size_t find_one(size_t pos = 0ul) const {
+        return bits::find_bit<true>(words_.data(), pos, N);
+    }
+
+    size_t find_zero_run(size_t n, size_t pos = 0ul) const {
+        return bits::find_zero_run(words_.data(), n, pos, N);
+    }
+
+    size_t find_best_zero_run(size_t n) const {
+        return bits::find_best_zero_run(words_.data(), n, N);
+    }
+
+    void set(size_t f, size_t l) { bits::assign<true>(words_.data(), f, l); }
+    void reset(size_t f, size_t l) { bits::assign<false>(words_.data(), f, l); }
+
+    size_t largest_zero_run() const { return bits::largest_zero_run(words_.data(), N); }
+
+    size_t count() const { return bits::count(words_.data(), words_.size()); }
+    bool none() const { return find_one() == N; }
+    bool all() const { return find_zero() == N; }
+
+    // direct access to underlying words
+    static constexpr size_t word_count() { return bits::words_for(N); }
+    bits::word_type* data() { return words_.data(); }
+    const bits::word_type* data() const { return words_.data(); }
+
+private:
+    std::array<bits::word_type, bits::words_for(N)> words_ = {};
+};
+
+// Runtime-sized bitmap over words owned by somebody else.
+class bitmap_view {
+public:
+    bitmap_view(bits::word_type* words, size_t size) : words_(words), size_(size) {}
+
+    size_t size() const { return size_; }
+    size_t npos() const { return size_; }
+
+    bool test(size_t pos) const {
+        return (words_[pos / bits::word_bits] >> (pos % bits::word_bits)) & 1u;
+    }
+
+    size_t find_zero(size_t pos = 0ul) const { return bits::find_bit<false>(words_, pos, size_); }
+    size_t find_one(size_t pos = 0ul) const { return bits::find_bit<true>(words_, pos, size_); }
+
+    size_t find_zero_run(size_t n, size_t pos = 0ul) const {
+        return bits::find_zero_run(words_, n, pos, size_);
+    }
+
+    size_t find_best_zero_run(size_t n) const { return bits::find_best_zero_run(words_, n, size_); }
+
+    void set(size_t f, size_t l) { bits::assign<true>(words_, f, l); }
+    void reset(size_t f, size_t l) { bits::assign<false>(words_, f, l); }
+
+    size_t largest_zero_run() const { return bits::largest_zero_run(words_, size_); }
+
+    size_t count() const { return bits::count(words_, word_count()); }
+    bool none() const { return find_one() == size_; }
+    bool all() const { return find_zero() == size_; }
+
+    size_t word_count() const { return bits::words_for(size_); }
+    bits::word_type* data() const { return words_; }
+
+private:
+    bits::word_type* words_;
+    size_t size_;
+};
+
+} // namespace griha
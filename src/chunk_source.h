@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <new>
+#include <vector>
+#include <utility>
+#include <cstdlib>
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace griha {
+
+// Upstream sources of memory for chunks of arenas.
+// Source provides blocks of size bytes aligned on alignment (power of two)
+// and takes them back with the same size. It throws std::bad_alloc if memory is exhausted.
+// Source does not initialize memory, arena zeroes only metadata of chunks eagerly.
+
+// blocks from heap of C runtime
+struct malloc_source {
+    void* allocate(size_t size, size_t alignment) {
+        void* ret;
+        if (posix_memalign(&ret, std::max(alignment, sizeof(void*)), size) != 0)
+            throw std::bad_alloc();
+        return ret;
+    }
+
+    void deallocate(void* p, size_t /*size*/) { free(p); }
+};
+
+namespace details {
+
+inline size_t page_size() {
+    static const size_t ret = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return ret;
+}
+
+constexpr size_t huge_page_size = 2ul << 20;
+
+inline size_t round_up(size_t v, size_t a) { return (v + a - 1) / a * a; }
+
+// maps size bytes aligned on alignment, excessive head and tail of mapping are unmapped
+inline void* map_aligned(size_t size, size_t alignment, int prot, int flags) {
+    size = round_up(size, page_size());
+    auto reserve = alignment > page_size() ? size + alignment : size;
+    auto p = mmap(nullptr, reserve, prot, flags, -1, 0);
+    if (p == MAP_FAILED)
+        return nullptr;
+
+    auto addr = reinterpret_cast<uintptr_t>(p);
+    auto aligned = round_up(addr, std::max(alignment, page_size()));
+    if (aligned != addr)
+        munmap(p, aligned - addr);
+    if (aligned + size != addr + reserve)
+        munmap(reinterpret_cast<void*>(aligned + size), addr + reserve - aligned - size);
+    return reinterpret_cast<void*>(aligned);
+}
+
+} // namespace details
+
+enum class huge_pages {
+    none,
+    transparent, // advises kernel to back mapping by transparent huge pages
+    hugetlb      // maps explicitly reserved huge pages, falls back to transparent ones
+};
+
+// every block is separate anonymous mapping, pages are populated on first touch
+template <huge_pages HugePages = huge_pages::none>
+struct mmap_source {
+    void* allocate(size_t size, size_t alignment) {
+        if (HugePages != huge_pages::none) {
+            size = details::round_up(size, details::huge_page_size);
+            alignment = std::max(alignment, details::huge_page_size);
+        }
+
+        void* ret = nullptr;
+#if defined(MAP_HUGETLB)
+        if (HugePages == huge_pages::hugetlb)
+            ret = details::map_aligned(size, alignment, PROT_READ | PROT_WRITE,
+                                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB);
+#endif
+        if (ret == nullptr) {
+            ret = details::map_aligned(size, alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS);
+            if (ret == nullptr)
+                throw std::bad_alloc();
+#if defined(MADV_HUGEPAGE)
+            if (HugePages != huge_pages::none)
+                madvise(ret, size, MADV_HUGEPAGE);
+#endif
+        }
+        return ret;
+    }
+
+    void deallocate(void* p, size_t size) {
+        munmap(p, details::round_up(size, HugePages != huge_pages::none ? details::huge_page_size
+                                                                        : details::page_size()));
+    }
+};
+
+// Reserves virtual address range of ReserveBytes up front without backing memory
+// and commits parts of it on demand. Freed blocks are decommitted and their ranges are reused.
+// Free ranges are kept sorted by address and adjacent ones are merged, padding skipped
+// for alignment is free as well. Another range is reserved if the current one is exhausted.
+template <size_t ReserveBytes = (1ul << 32)>
+class reserved_source {
+public:
+    reserved_source() = default;
+    reserved_source(const reserved_source&) = delete;
+    reserved_source& operator= (const reserved_source&) = delete;
+
+    // moved-from source is left empty
+    reserved_source(reserved_source&& src) noexcept { swap(src); }
+
+    reserved_source& operator= (reserved_source&& rhs) noexcept {
+        reserved_source t(std::move(rhs));
+        swap(t);
+        return *this;
+    }
+
+    ~reserved_source() {
+        for (auto& r : reservations_)
+            munmap(r.first, r.second);
+    }
+
+    void* allocate(size_t size, size_t alignment) {
+        size = details::round_up(size, details::page_size());
+        alignment = std::max(alignment, details::page_size());
+
+        auto ret = take_free_range(size, alignment);
+        if (ret == nullptr)
+            ret = bump(size, alignment);
+
+        if (mprotect(ret, size, PROT_READ | PROT_WRITE) != 0) {
+            release_range(ret, size);
+            throw std::bad_alloc();
+        }
+        return ret;
+    }
+
+    void deallocate(void* p, size_t size) {
+        size = details::round_up(size, details::page_size());
+        madvise(p, size, MADV_DONTNEED);
+        mprotect(p, size, PROT_NONE);
+        release_range(static_cast<char*>(p), size);
+    }
+
+    void swap(reserved_source& other) noexcept {
+        reservations_.swap(other.reservations_);
+        free_ranges_.swap(other.free_ranges_);
+        std::swap(cur_, other.cur_);
+        std::swap(end_, other.end_);
+    }
+
+private:
+    // the first free range fitting aligned block, the rest of range stays free
+    char* take_free_range(size_t size, size_t alignment) {
+        for (auto it = free_ranges_.begin(); it != free_ranges_.end(); ++it) {
+            auto [p, n] = *it;
+            auto aligned = reinterpret_cast<char*>(details::round_up(reinterpret_cast<uintptr_t>(p), alignment));
+            if (aligned + size > p + n)
+                continue;
+            if (aligned != p) {
+                it->second = aligned - p;
+                if (aligned + size != p + n)
+                    free_ranges_.insert(it + 1, {aligned + size, p + n - aligned - size});
+            } else if (n == size)
+                free_ranges_.erase(it);
+            else
+                *it = {p + size, n - size};
+            return aligned;
+        }
+        return nullptr;
+    }
+
+    void release_range(char* p, size_t n) {
+        if (n == 0)
+            return;
+
+        auto next = std::lower_bound(free_ranges_.begin(), free_ranges_.end(), p,
+                                     [] (const auto& r, char* p) { return r.first < p; });
+        bool joins_next = next != free_ranges_.end() && p + n == next->first;
+        if (next != free_ranges_.begin()) {
+            auto prev = next - 1;
+            if (prev->first + prev->second == p) {
+                prev->second += n;
+                if (joins_next) {
+                    prev->second += next->second;
+                    free_ranges_.erase(next);
+                }
+                return;
+            }
+        }
+        if (joins_next)
+            *next = {p, n + next->second};
+        else
+            free_ranges_.insert(next, {p, n});
+    }
+
+    char* bump(size_t size, size_t alignment) {
+        auto aligned = details::round_up(reinterpret_cast<uintptr_t>(cur_), alignment);
+        if (cur_ == nullptr || aligned + size > reinterpret_cast<uintptr_t>(end_)) {
+            auto reserve = std::max(ReserveBytes, size + alignment);
+            auto p = details::map_aligned(reserve, alignment, PROT_NONE,
+                                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE);
+            if (p == nullptr)
+                throw std::bad_alloc();
+            release_range(cur_, end_ - cur_); // tail of exhausted reservation
+            reserve = details::round_up(reserve, details::page_size());
+            reservations_.emplace_back(p, reserve);
+            cur_ = static_cast<char*>(p);
+            end_ = cur_ + reserve;
+            aligned = reinterpret_cast<uintptr_t>(cur_);
+        }
+        release_range(cur_, aligned - reinterpret_cast<uintptr_t>(cur_)); // padding
+        cur_ = reinterpret_cast<char*>(aligned + size);
+        return reinterpret_cast<char*>(aligned);
+    }
+
+private:
+    std::vector<std::pair<void*, size_t>> reservations_;
+    std::vector<std::pair<char*, size_t>> free_ranges_; // sorted by address
+    char* cur_ = nullptr;
+    char* end_ = nullptr;
+};
+
+} // namespace griha
@@ -0,0 +1,332 @@
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+namespace griha {
+
+// Doubly linked list with nodes linked by indices instead of pointers.
+// Nodes live in slab of segments of SegmentN nodes each, every segment is a single allocation
+// (so a chunked one of allocator_arena when SegmentN fits its chunks). Node of index i is
+// node i % SegmentN of segment i / SegmentN, segments are never moved, so iterators and
+// references stay valid as in bidirectional_list. Links are independent of addresses,
+// node of small T takes sizeof(T) + 2 * sizeof(Index) bytes.
+template <typename T, typename Index = uint32_t, size_t SegmentN = 256, typename Alloc = std::allocator<T>>
+class compact_list {
+    static_assert(std::is_unsigned_v<Index>, "index should be of unsigned type");
+    static_assert(SegmentN != 0 && (SegmentN & (SegmentN - 1)) == 0, "segment size should be power of two");
+
+public:
+    using value_type = T;
+    using reference = T&;
+    using const_reference = const T&;
+    using index_type = Index;
+
+    static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+private:
+    struct node {
+        T value;
+        index_type prev;
+        index_type next; // links free slots too
+    };
+
+    template <bool Const>
+    class iterator_inner {
+        template <typename, typename, size_t, typename> friend class compact_list;
+        friend class iterator_inner<!Const>;
+
+        using list_type = std::conditional_t<!Const, compact_list, const compact_list>;
+
+    public:
+        using value_type = compact_list::value_type;
+        using reference = std::conditional_t<!Const, T&, const T&>;
+        using pointer = std::conditional_t<!Const, T*, const T*>;
+        using difference_type = ptrdiff_t;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+    public:
+        iterator_inner(const iterator_inner&) = default;
+        iterator_inner& operator=(const iterator_inner&) = default;
+
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        iterator_inner(const iterator_inner<false>& src) : list_(src.list_), i_(src.i_) {}
+
+        reference operator* () const { return list_->at(i_).value; }
+        pointer operator-> () const { return &list_->at(i_).value; }
+
+        iterator_inner& operator++ () {
+            if (i_ != npos)
+                i_ = list_->at(i_).next;
+            return *this;
+        }
+
+        iterator_inner operator++ (int) {
+            auto ret = *this;
+            ++(*this);
+            return ret;
+        }
+
+        iterator_inner& operator-- () {
+            i_ = i_ != npos ? list_->at(i_).prev : list_->tail_;
+            return *this;
+        }
+
+        iterator_inner operator-- (int) {
+            auto ret = *this;
+            --(*this);
+            return ret;
+        }
+
+        // index of element in slab of list
+        index_type index() const { return i_; }
+
+        friend
+        bool operator== (const iterator_inner& lhs, const iterator_inner& rhs) {
+            return lhs.i_ == rhs.i_;
+        }
+
+        friend
+        bool operator!= (const iterator_inner& lhs, const iterator_inner& rhs) {
+            return !(lhs == rhs);
+        }
+
+    private:
+        iterator_inner(list_type& list, index_type i) : list_(&list), i_(i) {}
+
+    private:
+        list_type* list_;
+        index_type i_;
+    };
+
+    using alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+    using alloc_traits = std::allocator_traits<alloc_type>;
+
+public:
+    using iterator = iterator_inner<false>;
+    using const_iterator = iterator_inner<true>;
+
+    using pointer = typename std::allocator_traits<Alloc>::pointer;
+    using const_pointer = typename std::allocator_traits<Alloc>::const_pointer;
+    using difference_type = ptrdiff_t;
+    using size_type = size_t;
+
+    using allocator_type = Alloc;
+
+    static constexpr size_type segment_size = SegmentN;
+
+public:
+    compact_list() {}
+    explicit compact_list(const Alloc& alloc) : alloc_(alloc) {}
+    ~compact_list() { release(); }
+
+    compact_list(const compact_list& src) {
+        insert(end(), src.begin(), src.end());
+    }
+
+    compact_list(compact_list&& src) {
+        swap(src);
+    }
+
+    // existing nodes are reused, so the list is left valid but partially assigned on exception
+    compact_list& operator= (const compact_list& rhs) {
+        if (&rhs != this)
+            assign(rhs.begin(), rhs.end());
+        return *this;
+    }
+
+    compact_list& operator= (compact_list&& rhs) {
+        swap(rhs);
+        return *this;
+    }
+
+    iterator begin() { return iterator(*this, head_); }
+    const_iterator begin() const { return const_iterator(*this, head_); }
+    const_iterator cbegin() const { return const_iterator(*this, head_); }
+
+    iterator end() { return iterator(*this, npos); }
+    const_iterator end() const { return const_iterator(*this, npos); }
+    const_iterator cend() const { return const_iterator(*this, npos); }
+
+    reference front() { return at(head_).value; }
+    const_reference front() const { return at(head_).value; }
+    reference back() { return at(tail_).value; }
+    const_reference back() const { return at(tail_).value; }
+
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        auto i = acquire();
+        try {
+            alloc_traits::construct(alloc_, reinterpret_cast<pointer>(&at(i)), std::forward<Args>(args)...);
+        } catch (...) {
+            put_free(i);
+            throw;
+        }
+
+        link(pos.i_, i);
+        ++size_;
+        return iterator(*this, i);
+    }
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args) { return *emplace(end(), std::forward<Args>(args)...); }
+
+    template <typename... Args>
+    reference emplace_front(Args&&... args) { return *emplace(begin(), std::forward<Args>(args)...); }
+
+    iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+
+    // inserts copies of [first, last) before pos and returns iterator to the first of them
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    iterator insert(const_iterator pos, InputIt first, InputIt last) {
+        if (first == last)
+            return iterator(*this, pos.i_);
+        auto ret = emplace(pos, *first);
+        for (++first; first != last; ++first)
+            emplace(pos, *first);
+        return ret;
+    }
+
+    iterator insert(const_iterator pos, std::initializer_list<T> values) {
+        return insert(pos, values.begin(), values.end());
+    }
+
+    void push_back(const T& value) { emplace(end(), value); }
+    void push_back(T&& value) { emplace(end(), std::move(value)); }
+    void push_front(const T& value) { emplace(begin(), value); }
+    void push_front(T&& value) { emplace(begin(), std::move(value)); }
+
+    void pop_back() { erase_node(tail_); }
+    void pop_front() { erase_node(head_); }
+
+    void erase(const_iterator pos) {
+        if (pos.i_ == npos)
+            return;
+        erase_node(pos.i_);
+    }
+
+    // values are assigned to existing elements in place, only surplus of range takes new slots
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void assign(InputIt first, InputIt last) {
+        auto i = head_;
+        for (; i != npos && first != last; i = at(i).next, ++first)
+            at(i).value = *first;
+        while (i != npos) {
+            auto next = at(i).next;
+            erase_node(i);
+            i = next;
+        }
+        insert(end(), first, last);
+    }
+
+    void assign(std::initializer_list<T> values) { assign(values.begin(), values.end()); }
+
+    // destroys elements keeping segments for reuse
+    void clear() {
+        for (auto i = head_; i != npos;) {
+            auto next = at(i).next;
+            alloc_traits::destroy(alloc_, reinterpret_cast<pointer>(&at(i)));
+            i = next;
+        }
+        head_ = tail_ = free_ = npos;
+        used_ = 0;
+        size_ = 0;
+    }
+
+    allocator_type get_allocator() const { return allocator_type(alloc_); }
+
+    size_type size() const { return size_; }
+    size_type max_size() const { return npos; }
+
+    // number of slots in allocated segments
+    size_type capacity() const { return segments_.size() * SegmentN; }
+
+    bool empty() const { return head_ == npos; }
+
+    void swap(compact_list& other) {
+        std::swap(alloc_, other.alloc_);
+        segments_.swap(other.segments_);
+        std::swap(head_, other.head_);
+        std::swap(tail_, other.tail_);
+        std::swap(free_, other.free_);
+        std::swap(used_, other.used_);
+        std::swap(size_, other.size_);
+    }
+
+private:
+    node& at(index_type i) { return segments_[i / SegmentN][i % SegmentN]; }
+    const node& at(index_type i) const { return segments_[i / SegmentN][i % SegmentN]; }
+
+    // takes slot from free list, from untouched part of the last segment or from new segment
+    index_type acquire() {
+        if (free_ != npos) {
+            auto ret = free_;
+            free_ = at(ret).next;
+            return ret;
+        }
+        if (used_ == capacity()) {
+            if (used_ >= size_type(npos) - SegmentN)
+                throw std::length_error("compact_list indices are exhausted");
+            segments_.reserve(segments_.size() + 1); // so push_back doesn't throw after allocation
+            segments_.push_back(alloc_traits::allocate(alloc_, SegmentN));
+        }
+        return static_cast<index_type>(used_++);
+    }
+
+    void put_free(index_type i) {
+        at(i).next = free_;
+        free_ = i;
+    }
+
+    void erase_node(index_type i) {
+        auto& n = at(i);
+        (n.next != npos ? at(n.next).prev : tail_) = n.prev;
+        (n.prev != npos ? at(n.prev).next : head_) = n.next;
+        --size_;
+
+        alloc_traits::destroy(alloc_, reinterpret_cast<pointer>(&n));
+        put_free(i);
+    }
+
+    // attaches node i before pos
+    void link(index_type pos, index_type i) {
+        auto& ref_from_r = pos != npos ? at(pos).prev : tail_;
+        auto& ref_from_l = ref_from_r != npos ? at(ref_from_r).next : head_;
+
+        at(i).prev = ref_from_r;
+        at(i).next = pos;
+        ref_from_r = ref_from_l = i;
+    }
+
+    void release() {
+        clear();
+        for (auto s : segments_)
+            alloc_traits::deallocate(alloc_, s, SegmentN);
+        segments_.clear();
+    }
+
+private:
+    alloc_type alloc_;
+    std::vector<node*> segments_;
+    index_type head_ = {npos};
+    index_type tail_ = {npos};
+    index_type free_ = {npos};
+    size_type used_ = {0}; // slots ever taken, the rest of the last segment is untouched
+    size_type size_ = {0};
+};
+
+template <typename T, typename Index, size_t SegmentN, typename Alloc>
+void swap(compact_list<T, Index, SegmentN, Alloc>& lhs, compact_list<T, Index, SegmentN, Alloc>& rhs) {
+    lhs.swap(rhs);
+}
+
+} // namespace griha
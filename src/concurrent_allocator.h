@@ -0,0 +1,304 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <unordered_set>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "bitmap.h"
+
+namespace griha {
+
+namespace details {
+
+struct thread_heap_base {
+    std::atomic<bool> abandoned = {false}; // owner thread has exited, heap may be adopted
+};
+
+// registry of alive concurrent arenas,
+// it is touched only on attaching of heaps, on exit of thread and on destruction of arena
+struct arena_registry {
+    std::mutex mutex;
+    std::unordered_set<uint64_t> alive;
+    uint64_t next_id = 1;
+
+    static arena_registry& instance() {
+        static arena_registry reg;
+        return reg;
+    }
+};
+
+// heaps of concurrent arenas attached to current thread
+struct thread_heaps {
+    struct entry {
+        uint64_t arena_id;
+        thread_heap_base* heap;
+    };
+
+    std::vector<entry> heaps;
+    entry last = {0, nullptr};
+
+    ~thread_heaps() {
+        auto& reg = arena_registry::instance();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (auto& e : heaps)
+            if (reg.alive.count(e.arena_id) != 0)
+                e.heap->abandoned.store(true, std::memory_order_release);
+    }
+
+    thread_heap_base* find(uint64_t arena_id) const {
+        for (auto& e : heaps)
+            if (e.arena_id == arena_id)
+                return e.heap;
+        return nullptr;
+    }
+
+    // forgets heaps of destroyed arenas
+    void prune() {
+        auto& reg = arena_registry::instance();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (auto it = heaps.begin(); it != heaps.end();)
+            it = reg.alive.count(it->arena_id) == 0 ? heaps.erase(it) : it + 1;
+    }
+};
+
+inline thread_local thread_heaps current_thread_heaps;
+
+} // namespace details
+
+// Thread-safe variant of allocator_arena.
+// Every thread allocates from its own heap of chunks without any synchronization.
+// Elements freed by another thread are marked in lock-free remote-free mask of owning chunk
+// and are returned into chunk state by owner thread lazily on its next allocation.
+// Heap of exited thread is adopted by the next thread attaching to the arena.
+template <typename T, size_t ChunkN>
+class concurrent_allocator_arena {
+
+    struct heap;
+
+    struct chunk {
+        bitmap<ChunkN> state; // touched by owner thread only
+        std::atomic<bits::word_type> remote[bitmap<ChunkN>::word_count()]; // freed by other threads
+        std::atomic<bool> has_remote;
+        heap* owner;
+        chunk* next;
+        T data[ChunkN];
+    };
+
+    struct heap : details::thread_heap_base {
+        std::atomic<size_t> remote_pending = {0}; // chunks got remote frees since last drain
+        chunk* head = nullptr;
+        T* free_list = nullptr;
+    };
+
+    // chunks are allocated aligned on its own (power of two) size,
+    // so owning chunk of any element is found by masking of its address
+    static constexpr size_t chunk_alignment = bits::ceil_pow2(sizeof(chunk));
+
+    // single elements freed by owner thread are kept in intrusive LIFO list as in allocator_arena
+    static constexpr bool use_free_list = sizeof(T) >= sizeof(T*);
+
+public:
+    template <typename U>
+    struct rebind {
+        using other = concurrent_allocator_arena<U, ChunkN>;
+    };
+
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+public:
+    concurrent_allocator_arena() {
+        auto& reg = details::arena_registry::instance();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        id_ = reg.next_id++;
+        reg.alive.insert(id_);
+    }
+
+    ~concurrent_allocator_arena() {
+        {
+            auto& reg = details::arena_registry::instance();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.alive.erase(id_);
+        }
+        for (auto& h : heaps_)
+            for (auto p = h->head; p != nullptr;) {
+                auto t = p;
+                p = p->next;
+                free(t);
+            }
+    }
+
+    concurrent_allocator_arena(const concurrent_allocator_arena&) = delete;
+    concurrent_allocator_arena& operator= (const concurrent_allocator_arena&) = delete;
+
+    T* allocate(size_type n) {
+        if (n > ChunkN)
+            throw std::bad_alloc(); // only sequentially allocation is supported
+
+        if (n == 0)
+            return nullptr;
+
+        auto h = local_heap();
+        if constexpr (use_free_list) {
+            if (n == 1 && h->free_list != nullptr)
+                return pop_free(h);
+        }
+
+        if (h->remote_pending.load(std::memory_order_acquire) != 0)
+            drain_remote(h);
+
+        if (auto ret = find_free(h, n))
+            return ret;
+
+        if constexpr (use_free_list) {
+            if (h->free_list != nullptr) {
+                flush_free_list(h);
+                if (auto ret = find_free(h, n))
+                    return ret;
+            }
+        }
+
+        // no suitable chunk, create new
+        auto p = reinterpret_cast<chunk*>(aligned_alloc(chunk_alignment, chunk_alignment));
+        if (p == nullptr)
+            throw std::bad_alloc();
+
+        memset(static_cast<void*>(p), 0, sizeof(chunk));
+        p->owner = h;
+        p->next = h->head;
+        h->head = p;
+
+        p->state.set(0, n);
+        return p->data;
+    }
+
+    void deallocate(T* p, size_type n) {
+        if (p == nullptr)
+            return;
+
+        auto ch = chunk_of(p);
+        size_t i = p - ch->data;
+        if (i + n > ChunkN)
+            throw std::invalid_argument("n should contain value as in corresponding call of allocate");
+
+        auto h = local_heap();
+        if (ch->owner != h)
+            remote_free(ch, i, n);
+        else if (use_free_list && n == 1)
+            push_free(h, p);
+        else
+            ch->state.reset(i, i + n);
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        ::new(reinterpret_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U> void destroy(U* p) { p->~U(); }
+
+private:
+    static chunk* chunk_of(T* p) {
+        return reinterpret_cast<chunk*>(reinterpret_cast<uintptr_t>(p) & ~(chunk_alignment - 1));
+    }
+
+    heap* local_heap() {
+        auto& tls = details::current_thread_heaps;
+        if (tls.last.arena_id == id_)
+            return static_cast<heap*>(tls.last.heap);
+        return attach_heap(tls);
+    }
+
+    heap* attach_heap(details::thread_heaps& tls) {
+        auto h = static_cast<heap*>(tls.find(id_));
+        if (h == nullptr) {
+            tls.prune();
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& p : heaps_) {
+                bool abandoned = true;
+                if (p->abandoned.compare_exchange_strong(abandoned, false, std::memory_order_acq_rel)) {
+                    h = p.get();
+                    break;
+                }
+            }
+            if (h == nullptr) {
+                heaps_.push_back(std::make_unique<heap>());
+                h = heaps_.back().get();
+            }
+            tls.heaps.push_back({id_, h});
+        }
+        tls.last = {id_, h};
+        return h;
+    }
+
+    static void remote_free(chunk* ch, size_t i, size_t n) {
+        for (size_t f = i, l = i + n, wi = f / bits::word_bits; f < l; ++wi) {
+            auto wl = std::min(l, (wi + 1) * bits::word_bits);
+            ch->remote[wi].fetch_or(bits::range_mask(f % bits::word_bits, (wl - 1) % bits::word_bits + 1),
+                                    std::memory_order_release);
+            f = wl;
+        }
+        if (!ch->has_remote.exchange(true, std::memory_order_acq_rel))
+            ch->owner->remote_pending.fetch_add(1, std::memory_order_release);
+    }
+
+    static void drain_remote(heap* h) {
+        h->remote_pending.exchange(0, std::memory_order_acquire);
+        for (auto p = h->head; p != nullptr; p = p->next) {
+            if (!p->has_remote.load(std::memory_order_relaxed) ||
+                !p->has_remote.exchange(false, std::memory_order_acq_rel))
+                continue;
+
+            auto words = p->state.data();
+            for (size_t wi = 0; wi < p->state.word_count(); ++wi)
+                words[wi] &= ~p->remote[wi].exchange(0, std::memory_order_acquire);
+        }
+    }
+
+    static T* find_free(heap* h, size_type n) {
+        // find sequence of n free elements
+        for (auto p = h->head; p != nullptr; p = p->next) {
+            auto i = p->state.find_zero_run(n);
+            if (i == p->state.npos)
+                continue;
+            p->state.set(i, i + n); // set elements are busy
+            return &p->data[i]; // and return pointer on first element
+        }
+        return nullptr;
+    }
+
+    static void push_free(heap* h, T* p) {
+        memcpy(reinterpret_cast<void*>(p), &h->free_list, sizeof(h->free_list));
+        h->free_list = p;
+    }
+
+    static T* pop_free(heap* h) {
+        auto ret = h->free_list;
+        memcpy(&h->free_list, reinterpret_cast<void*>(ret), sizeof(h->free_list));
+        return ret;
+    }
+
+    static void flush_free_list(heap* h) {
+        for (; h->free_list != nullptr;) {
+            auto p = pop_free(h);
+            auto ch = chunk_of(p);
+            size_t i = p - ch->data;
+            ch->state.reset(i, i + 1);
+        }
+    }
+
+private:
+    uint64_t id_;
+    std::mutex mutex_; // guards list of heaps
+    std::vector<std::unique_ptr<heap>> heaps_;
+};
+
+} // namespace griha
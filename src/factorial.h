@@ -1,9 +1,18 @@
 #pragma once
 
+#include <array>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <cstdint>
+
+#include "big_integer.h"
+
 namespace griha {
 
 template <unsigned V>
 struct factorial {
+    static_assert(V <= 12, "factorial overflows unsigned, use factorial64_v or big_fact");
     static constexpr unsigned value = V * factorial<V - 1>::value;
 };
 
@@ -20,10 +29,126 @@ struct factorial<0> {
 template <unsigned V>
 constexpr unsigned factorial_v = factorial<V>::value;
 
+// throws on overflow of unsigned, so it doesn't compile in constant expressions past 12!
 constexpr unsigned fact(unsigned value) {
+    if (value > 12)
+        throw std::overflow_error("factorial overflows unsigned");
     if (value == 0 || value == 1)
         return 1;
     return value * fact(value - 1);
 }
 
-} // namespace griha
\ No newline at end of file
+namespace details {
+
+constexpr auto make_factorial_table() {
+    std::array<uint64_t, 21> ret = {1};
+    for (size_t i = 1; i < ret.size(); ++i)
+        ret[i] = ret[i - 1] * i;
+    return ret;
+}
+
+} // namespace details
+
+// all factorials fitting uint64_t, 20! is the largest one
+inline constexpr std::array<uint64_t, 21> factorial_table = details::make_factorial_table();
+
+// throws on overflow of uint64_t, so it doesn't compile in constant expressions past 20!
+constexpr uint64_t fact64(unsigned value) {
+    if (value >= factorial_table.size())
+        throw std::overflow_error("factorial overflows uint64_t");
+    return factorial_table[value];
+}
+
+template <unsigned V>
+constexpr uint64_t factorial64_v = fact64(V);
+
+namespace details {
+
+// factors are packed in words of uint64_t as long as their product fits
+class factor_words {
+public:
+    void push(uint64_t f) {
+        if (acc_ > std::numeric_limits<uint64_t>::max() / f) {
+            words_.push_back(acc_);
+            acc_ = 1;
+        }
+        acc_ *= f;
+    }
+
+    std::vector<uint64_t> release() {
+        if (acc_ != 1)
+            words_.push_back(acc_);
+        acc_ = 1;
+        return std::move(words_);
+    }
+
+private:
+    std::vector<uint64_t> words_;
+    uint64_t acc_ = 1;
+};
+
+// Product of words [first, last) by binary splitting, so operands of multiplications
+// are of about equal length and large ones are multiplied by Karatsuba's method.
+inline big_uint product(const uint64_t* first, const uint64_t* last) {
+    auto n = last - first;
+    if (n == 0)
+        return 1;
+    if (n == 1)
+        return *first;
+    auto mid = first + n / 2;
+    return product(first, mid) * product(mid, last);
+}
+
+inline std::vector<uint64_t> factorial_words(unsigned value) {
+    factor_words words;
+    for (uint64_t i = 2; i <= value; ++i)
+        words.push(i);
+    return words.release();
+}
+
+inline std::vector<unsigned> primes_upto(unsigned n) {
+    std::vector<bool> composite(size_t(n) + 1, false);
+    std::vector<unsigned> ret;
+    for (uint64_t i = 2; i <= n; ++i) {
+        if (composite[i])
+            continue;
+        ret.push_back(unsigned(i));
+        for (auto j = i * i; j <= n; j += i)
+            composite[j] = true;
+    }
+    return ret;
+}
+
+// exponent of prime p in n! by Legendre's formula
+inline unsigned legendre(unsigned n, unsigned p) {
+    unsigned ret = 0;
+    for (uint64_t q = p; q <= n; q *= p)
+        ret += unsigned(n / q);
+    return ret;
+}
+
+} // namespace details
+
+// exact factorial of any value
+inline big_uint big_fact(unsigned value) {
+    auto words = details::factorial_words(value);
+    return details::product(words.data(), words.data() + words.size());
+}
+
+// Binomial coefficient C(n, k) as product of prime powers. Exponent of every prime is found
+// by Legendre's formula, so there is no division of big numbers.
+inline big_uint big_binomial(unsigned n, unsigned k) {
+    if (k > n)
+        return 0;
+
+    details::factor_words words;
+    for (auto p : details::primes_upto(n)) {
+        auto e = details::legendre(n, p) - details::legendre(k, p) - details::legendre(n - k, p);
+        for (; e != 0; --e)
+            words.push(p);
+    }
+    auto w = words.release();
+    return details::product(w.data(), w.data() + w.size());
+}
+
+} // namespace griha
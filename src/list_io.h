@@ -0,0 +1,316 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <cerrno>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "bidirectional_list.h"
+
+namespace griha {
+
+// Binary snapshots of lists of trivially copyable values: header followed by values
+// in list order as bytes in native byte order, so files are not portable between architectures.
+// Values of at least direct_io_size bytes are written from nodes and read into nodes
+// by scatter-gather I/O. Smaller ones go through staging buffer, since kernel handles
+// each buffer of readv/writev slower than memcpy copies a small value.
+// Errors of I/O throw std::system_error, malformed files throw std::runtime_error.
+
+struct list_file_header {
+    static constexpr char magic_value[8] = {'G', 'H', 'L', 'I', 'S', 'T', '0', '1'};
+
+    char magic[8];
+    uint32_t version;
+    uint32_t value_size;
+    uint64_t count;
+};
+
+namespace details {
+
+// number of buffers per call of readv/writev, IOV_MAX of Linux
+constexpr size_t iov_group = 1024;
+
+constexpr size_t direct_io_size = 1024;
+constexpr size_t staging_size = 1ul << 18;
+
+// transfers all buffers, continues after partial transfers and interrupts
+template <bool Write>
+void transfer(int fd, iovec* iov, size_t n) {
+    while (n != 0) {
+        auto count = static_cast<int>(std::min(n, iov_group));
+        auto done = Write ? writev(fd, iov, count) : readv(fd, iov, count);
+        if (done < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::system_error(errno, std::generic_category(), Write ? "writev" : "readv");
+        }
+        if (done == 0)
+            throw std::runtime_error("list file is truncated");
+
+        auto left = static_cast<size_t>(done);
+        for (; n != 0 && left >= iov->iov_len; --n, ++iov)
+            left -= iov->iov_len;
+        if (left != 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+}
+
+template <bool Write>
+void transfer(int fd, void* p, size_t size) {
+    iovec iov = {p, size};
+    transfer<Write>(fd, &iov, size != 0 ? 1 : 0);
+}
+
+// file descriptor closed on destruction
+class file {
+public:
+    file(const std::string& path, int flags) : fd_(::open(path.c_str(), flags, 0644)) {
+        if (fd_ < 0)
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+    }
+
+    ~file() { ::close(fd_); }
+
+    file(const file&) = delete;
+    file& operator= (const file&) = delete;
+
+    int fd() const { return fd_; }
+
+private:
+    int fd_;
+};
+
+template <typename T>
+constexpr bool direct_io = sizeof(T) >= direct_io_size;
+
+// writes values by groups of addresses
+template <typename T>
+class value_sink {
+public:
+    explicit value_sink(int fd) : fd_(fd) {
+        if constexpr (!direct_io<T>)
+            buffer_.reset(new char[staging_size]);
+    }
+
+    void write(const void* p, size_t size) {
+        if constexpr (direct_io<T>) {
+            iovec iov = {const_cast<void*>(p), size};
+            transfer<true>(fd_, &iov, 1);
+        } else {
+            for (auto src = static_cast<const char*>(p); size != 0;) {
+                auto n = std::min(size, staging_size - used_);
+                memcpy(buffer_.get() + used_, src, n);
+                used_ += n;
+                src += n;
+                size -= n;
+                if (used_ == staging_size)
+                    flush();
+            }
+        }
+    }
+
+    void write(const T* const* values, size_t n) {
+        if constexpr (direct_io<T>) {
+            iovec iov[iov_group];
+            for (size_t i = 0; i < n; ++i)
+                iov[i] = {const_cast<T*>(values[i]), sizeof(T)};
+            transfer<true>(fd_, iov, n);
+        } else {
+            for (size_t i = 0; i < n; ++i)
+                write(values[i], sizeof(T));
+        }
+    }
+
+    void flush() {
+        transfer<true>(fd_, buffer_.get(), used_);
+        used_ = 0;
+    }
+
+private:
+    int fd_;
+    std::unique_ptr<char[]> buffer_;
+    size_t used_ = 0;
+};
+
+// reads limit bytes of values by groups of addresses, no more is read from file
+template <typename T>
+class value_source {
+public:
+    value_source(int fd, uint64_t limit) : fd_(fd), unread_(limit) {
+        if constexpr (!direct_io<T>)
+            buffer_.reset(new char[staging_size]);
+    }
+
+    void read(T* const* values, size_t n) {
+        if constexpr (direct_io<T>) {
+            iovec iov[iov_group];
+            for (size_t i = 0; i < n; ++i)
+                iov[i] = {values[i], sizeof(T)};
+            transfer<false>(fd_, iov, n);
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                auto dst = reinterpret_cast<char*>(values[i]);
+                for (size_t size = sizeof(T); size != 0;) {
+                    if (pos_ == end_)
+                        fill();
+                    auto m = std::min(size, end_ - pos_);
+                    memcpy(dst, buffer_.get() + pos_, m);
+                    pos_ += m;
+                    dst += m;
+                    size -= m;
+                }
+            }
+        }
+    }
+
+private:
+    void fill() {
+        if (unread_ == 0)
+            throw std::runtime_error("list file is truncated");
+        auto n = static_cast<size_t>(std::min<uint64_t>(staging_size, unread_));
+        transfer<false>(fd_, buffer_.get(), n);
+        unread_ -= n;
+        pos_ = 0;
+        end_ = n;
+    }
+
+private:
+    int fd_;
+    uint64_t unread_;
+    std::unique_ptr<char[]> buffer_;
+    size_t pos_ = 0;
+    size_t end_ = 0;
+};
+
+// Reads and validates header, returns number of values. Values should fit in the rest
+// of regular file, size of values in other files should be representable at least.
+inline uint64_t read_header(int fd, size_t value_size) {
+    list_file_header header;
+    transfer<false>(fd, &header, sizeof(header));
+    if (memcmp(header.magic, list_file_header::magic_value, sizeof(header.magic)) != 0 ||
+            header.version != 1)
+        throw std::runtime_error("not a list file");
+    if (header.value_size != value_size)
+        throw std::runtime_error("list file has values of another size");
+    if (header.count > std::numeric_limits<uint64_t>::max() / value_size)
+        throw std::runtime_error("list file has invalid count");
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        auto pos = lseek(fd, 0, SEEK_CUR);
+        if (pos >= 0 && header.count * value_size > static_cast<uint64_t>(std::max<off_t>(st.st_size - pos, 0)))
+            throw std::runtime_error("list file is truncated");
+    }
+    return header.count;
+}
+
+} // namespace details
+
+template <typename T, typename Alloc>
+void dump(const bidirectional_list<T, Alloc>& l, int fd) {
+    static_assert(std::is_trivially_copyable_v<T>, "values are written as bytes");
+
+    list_file_header header;
+    memcpy(header.magic, list_file_header::magic_value, sizeof(header.magic));
+    header.version = 1;
+    header.value_size = sizeof(T);
+    header.count = l.size();
+
+    details::value_sink<T> sink(fd);
+    sink.write(&header, sizeof(header));
+    const T* values[details::iov_group];
+    size_t n = 0;
+    for (auto& v : l) {
+        values[n++] = &v;
+        if (n == details::iov_group) {
+            sink.write(values, n);
+            n = 0;
+        }
+    }
+    sink.write(values, n);
+    if constexpr (!details::direct_io<T>)
+        sink.flush();
+}
+
+template <typename T, typename Alloc>
+void dump(const bidirectional_list<T, Alloc>& l, const std::string& path) {
+    details::file f(path, O_WRONLY | O_CREAT | O_TRUNC);
+    dump(l, f.fd());
+}
+
+// Reads list file by chunks of elements, so lists larger than memory budget are processed
+// incrementally. Nodes of chunk list are reused and new ones are allocated in batches.
+// Nothing past the list is read from file. File descriptor is not owned by reader.
+template <typename T>
+class list_reader {
+    static_assert(std::is_trivially_copyable_v<T>, "values are read as bytes");
+
+public:
+    explicit list_reader(int fd)
+        : size_(details::read_header(fd, sizeof(T)))
+        , remaining_(size_)
+        , source_(fd, size_ * sizeof(T)) {}
+
+    uint64_t size() const { return size_; }
+    uint64_t remaining() const { return remaining_; }
+
+    // Replaces content of chunk by at most max_n next elements, returns their number.
+    // On exception chunk keeps values read before the failure, the rest of its values is unspecified.
+    template <typename Alloc>
+    size_t read(bidirectional_list<T, Alloc>& chunk, size_t max_n) {
+        auto n = static_cast<size_t>(std::min<uint64_t>(max_n, remaining_));
+
+        T* values[details::iov_group];
+        size_t k = 0, reused = 0;
+        for (auto it = chunk.begin(); it != chunk.end() && reused < n; ++it, ++reused) {
+            values[k++] = &*it;
+            if (k == details::iov_group) {
+                source_.read(values, k);
+                k = 0;
+            }
+        }
+        source_.read(values, k);
+        while (chunk.size() > n)
+            chunk.pop_back();
+
+        chunk.append_uninitialized(n - reused, [this] (T* const* values, size_t m) {
+            source_.read(values, m);
+        });
+        remaining_ -= n;
+        return n;
+    }
+
+private:
+    uint64_t size_;
+    uint64_t remaining_;
+    details::value_source<T> source_;
+};
+
+// replaces content of list by file
+template <typename T, typename Alloc>
+void load(bidirectional_list<T, Alloc>& l, int fd) {
+    list_reader<T> reader(fd);
+    reader.read(l, reader.size());
+}
+
+template <typename T, typename Alloc>
+void load(bidirectional_list<T, Alloc>& l, const std::string& path) {
+    details::file f(path, O_RDONLY);
+    load(l, f.fd());
+}
+
+} // namespace griha
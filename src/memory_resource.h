@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <memory_resource>
+#include <tuple>
+#include <utility>
+#include <cstddef>
+
+#include "allocator.h"
+#include "monotonic_buffer.h"
+
+namespace griha {
+
+// Pool memory resource over chunked arenas.
+// Blocks up to max_block bytes are served by arenas of power of two size classes,
+// so containers of different element types built with std::pmr::polymorphic_allocator
+// share the same pools. Larger blocks are passed to upstream resource.
+// As std::pmr::unsynchronized_pool_resource it is not thread-safe.
+template <typename UpstreamSource = malloc_source>
+class arena_pool_resource : public std::pmr::memory_resource {
+
+    template <size_t Size>
+    struct alignas(Size) slot {
+        unsigned char bytes[Size];
+    };
+
+    template <size_t Size>
+    using pool = allocator_arena<slot<Size>, 1ul, reclaim_keep_spare<1>, grow_fixed, UpstreamSource>;
+
+    static constexpr size_t min_block_shift = 3;
+    static constexpr size_t classes_n = 10;
+
+    template <size_t... I>
+    static auto pools_type(std::index_sequence<I...>) -> std::tuple<pool<(size_t(1) << (min_block_shift + I))>...>;
+
+    using pools = decltype(pools_type(std::make_index_sequence<classes_n>()));
+
+public:
+    static constexpr size_t min_block = 1ul << min_block_shift;
+    static constexpr size_t max_block = min_block << (classes_n - 1);
+
+public:
+    // every chunk of pools takes about chunk_bytes
+    explicit arena_pool_resource(size_t chunk_bytes = 1ul << 16,
+                                 std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : pools_(make_pools(chunk_bytes, std::make_index_sequence<classes_n>())),
+          upstream_(upstream) {}
+
+    arena_pool_resource(const arena_pool_resource&) = delete;
+    arena_pool_resource& operator= (const arena_pool_resource&) = delete;
+
+    std::pmr::memory_resource* upstream_resource() const { return upstream_; }
+
+    // releases empty chunks of all pools
+    void trim() { trim(std::make_index_sequence<classes_n>()); }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        auto cls = size_class(bytes, alignment);
+        if (cls >= classes_n)
+            return upstream_->allocate(bytes, alignment);
+        return allocate_fns[cls](pools_);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        auto cls = size_class(bytes, alignment);
+        if (cls >= classes_n)
+            upstream_->deallocate(p, bytes, alignment);
+        else
+            deallocate_fns[cls](pools_, p);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    static size_t size_class(size_t bytes, size_t alignment) {
+        auto size = std::max(std::max(bytes, alignment), min_block);
+        return bits::word_bits - __builtin_clzll(size - 1) - min_block_shift;
+    }
+
+    // number of blocks fitting in chunk_bytes together with (overestimated) chunk header
+    static size_t capacity(size_t chunk_bytes, size_t size) {
+        auto header = (64ul + (chunk_bytes / size / bits::word_bits + 1) * sizeof(bits::word_type) + size - 1)
+                      / size * size;
+        return chunk_bytes > header + size ? (chunk_bytes - header) / size : 1ul;
+    }
+
+    template <size_t... I>
+    static pools make_pools(size_t chunk_bytes, std::index_sequence<I...>) {
+        return pools(capacity(chunk_bytes, size_t(1) << (min_block_shift + I))...);
+    }
+
+    template <size_t I>
+    static void* allocate_from(pools& p) { return std::get<I>(p).allocate(1ul); }
+
+    template <size_t I>
+    static void deallocate_to(pools& p, void* ptr) {
+        using slot_type = typename std::tuple_element_t<I, pools>::value_type;
+        std::get<I>(p).deallocate(static_cast<slot_type*>(ptr), 1ul);
+    }
+
+    template <size_t... I>
+    void trim(std::index_sequence<I...>) { (std::get<I>(pools_).trim(), ...); }
+
+    template <size_t... I>
+    static constexpr auto allocate_table(std::index_sequence<I...>) {
+        return std::array<void* (*)(pools&), sizeof...(I)>{&allocate_from<I>...};
+    }
+
+    template <size_t... I>
+    static constexpr auto deallocate_table(std::index_sequence<I...>) {
+        return std::array<void (*)(pools&, void*), sizeof...(I)>{&deallocate_to<I>...};
+    }
+
+    static constexpr auto allocate_fns = allocate_table(std::make_index_sequence<classes_n>());
+    static constexpr auto deallocate_fns = deallocate_table(std::make_index_sequence<classes_n>());
+
+private:
+    pools pools_;
+    std::pmr::memory_resource* upstream_;
+};
+
+// Monotonic memory resource over chunks of upstream source.
+// Deallocation does nothing, memory is reused after reset() and returned by release().
+template <typename UpstreamSource = malloc_source>
+class arena_monotonic_resource : public std::pmr::memory_resource {
+public:
+    explicit arena_monotonic_resource(size_t chunk_bytes = 4096ul) : buffer_(chunk_bytes) {}
+
+    arena_monotonic_resource(const arena_monotonic_resource&) = delete;
+    arena_monotonic_resource& operator= (const arena_monotonic_resource&) = delete;
+
+    void reset() { buffer_.reset(); }
+    void release() { buffer_.release(); }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        return buffer_.allocate(std::max(bytes, size_t(1)), alignment);
+    }
+
+    void do_deallocate(void* /*p*/, size_t /*bytes*/, size_t /*alignment*/) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    monotonic_buffer<UpstreamSource> buffer_;
+};
+
+} // namespace griha
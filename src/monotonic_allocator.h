@@ -0,0 +1,71 @@
+#pragma once
+
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <cstddef>
+
+#include "monotonic_buffer.h"
+
+namespace griha {
+
+// Monotonic arena for request-scoped containers.
+// Allocation bumps pointer in the current chunk, deallocation does nothing.
+// reset() rewinds all chunks at once for reuse by the next request keeping memory.
+template <typename UpstreamSource = malloc_source>
+using monotonic_arena = monotonic_buffer<UpstreamSource>;
+
+// Allocator over monotonic arena. It is a handle to the arena which is owned by user,
+// so containers of any element types share the arena and it is reset outside of them.
+// Containers should be destroyed or cleared before reset() of their arena.
+template <typename T, typename UpstreamSource = malloc_source>
+class monotonic_allocator {
+public:
+    template <typename U>
+    struct rebind {
+        using other = monotonic_allocator<U, UpstreamSource>;
+    };
+
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+public:
+    monotonic_allocator(monotonic_arena<UpstreamSource>& arena) : arena_(&arena) {}
+
+    template <typename U>
+    monotonic_allocator(const monotonic_allocator<U, UpstreamSource>& other) : arena_(&other.arena()) {}
+
+    T* allocate(size_type n) {
+        if (n > std::numeric_limits<size_type>::max() / sizeof(T))
+            throw std::bad_alloc();
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* /*p*/, size_type /*n*/) {}
+
+    // deallocation does nothing, so any run of allocated elements may be deallocated at once
+    size_type max_piecewise_size() const { return std::numeric_limits<size_type>::max(); }
+
+    monotonic_arena<UpstreamSource>& arena() const { return *arena_; }
+
+    template <typename U>
+    friend bool operator== (const monotonic_allocator& lhs, const monotonic_allocator<U, UpstreamSource>& rhs) {
+        return &lhs.arena() == &rhs.arena();
+    }
+
+    template <typename U>
+    friend bool operator!= (const monotonic_allocator& lhs, const monotonic_allocator<U, UpstreamSource>& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    monotonic_arena<UpstreamSource>* arena_;
+};
+
+} // namespace griha
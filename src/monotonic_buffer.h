@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+
+#include "chunk_source.h"
+
+namespace griha {
+
+// Untyped bump-pointer buffer over chunks of upstream source.
+// Allocation advances pointer in the current chunk, deallocation is not supported at all.
+// reset() rewinds all chunks for reuse keeping memory, release() returns memory to source.
+// Every next chunk is twice larger than the previous one up to MaxFactor times of initial size.
+template <typename UpstreamSource = malloc_source, size_t MaxFactor = 64>
+class monotonic_buffer {
+
+    struct chunk {
+        chunk* next;
+        size_t size; // in bytes including header
+    };
+
+    static constexpr size_t header_size = (sizeof(chunk) + alignof(std::max_align_t) - 1)
+                                          / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+public:
+    explicit monotonic_buffer(size_t chunk_bytes = 4096ul)
+        : chunk_bytes_(std::max(chunk_bytes, header_size + 1)) {}
+
+    monotonic_buffer(const monotonic_buffer&) = delete;
+    monotonic_buffer& operator= (const monotonic_buffer&) = delete;
+
+    ~monotonic_buffer() { release(); }
+
+    void* allocate(size_t bytes, size_t alignment) {
+        auto p = align(cur_, alignment);
+        if (p <= end_ && static_cast<size_t>(end_ - p) >= bytes) {
+            cur_ = p + bytes;
+            return p;
+        }
+        return allocate_slow(bytes, alignment);
+    }
+
+    // rewinds to the first chunk, all previously allocated memory is reused
+    void reset() {
+        current_ = head_;
+        if (current_ != nullptr)
+            set_current(current_);
+    }
+
+    // returns all chunks to upstream source
+    void release() {
+        for (auto p = head_; p != nullptr;) {
+            auto t = p;
+            p = p->next;
+            source_.deallocate(t, t->size);
+        }
+        head_ = tail_ = current_ = nullptr;
+        cur_ = end_ = nullptr;
+        last_size_ = 0;
+    }
+
+    // number of chunks held
+    size_t chunk_count() const {
+        size_t ret = 0;
+        for (auto p = head_; p != nullptr; p = p->next, ++ret);
+        return ret;
+    }
+
+private:
+    static char* align(char* p, size_t alignment) {
+        auto v = reinterpret_cast<uintptr_t>(p);
+        return reinterpret_cast<char*>((v + alignment - 1) & ~(alignment - 1));
+    }
+
+    void set_current(chunk* c) {
+        current_ = c;
+        cur_ = reinterpret_cast<char*>(c) + header_size;
+        end_ = reinterpret_cast<char*>(c) + c->size;
+    }
+
+    void* allocate_slow(size_t bytes, size_t alignment) {
+        // try chunks left after reset
+        for (auto c = current_ != nullptr ? current_->next : nullptr; c != nullptr; c = c->next) {
+            set_current(c);
+            auto p = align(cur_, alignment);
+            if (p <= end_ && static_cast<size_t>(end_ - p) >= bytes) {
+                cur_ = p + bytes;
+                return p;
+            }
+        }
+
+        if (bytes > std::numeric_limits<size_t>::max() / 2 - header_size - alignment)
+            throw std::bad_alloc();
+
+        auto size = last_size_ == 0 ? chunk_bytes_ : std::min(last_size_ * 2, chunk_bytes_ * MaxFactor);
+        size = std::max(size, header_size + bytes + alignment);
+        auto c = static_cast<chunk*>(source_.allocate(size, alignof(std::max_align_t)));
+        c->next = nullptr;
+        c->size = size;
+        (tail_ != nullptr ? tail_->next : head_) = c;
+        tail_ = c;
+        last_size_ = size;
+
+        set_current(c);
+        auto p = align(cur_, alignment);
+        cur_ = p + bytes;
+        return p;
+    }
+
+private:
+    UpstreamSource source_;
+    size_t chunk_bytes_;
+    size_t last_size_ = 0;
+
+    chunk* head_ = nullptr;
+    chunk* tail_ = nullptr;
+    chunk* current_ = nullptr;
+    char* cur_ = nullptr;
+    char* end_ = nullptr;
+};
+
+} // namespace griha
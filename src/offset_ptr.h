@@ -0,0 +1,126 @@
+#pragma once
+
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+namespace griha {
+
+// Self-relative fancy pointer: it keeps distance from its own address to pointee,
+// so structures linked by offset pointers stay valid wherever their memory is mapped
+// as long as pointers and pointees are moved together. Copy recomputes distance.
+// Distance 1 stands for null pointer (a pointer never points inside itself).
+template <typename T>
+class offset_ptr {
+    template <typename> friend class offset_ptr;
+
+    template <typename U>
+    using ref_t = std::add_lvalue_reference_t<U>;
+
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using pointer = offset_ptr;
+    using reference = ref_t<T>;
+    using difference_type = ptrdiff_t;
+    using iterator_category = std::random_access_iterator_tag;
+
+    template <typename U>
+    using rebind = offset_ptr<U>;
+
+public:
+    offset_ptr() noexcept = default;
+    offset_ptr(std::nullptr_t) noexcept {}
+    offset_ptr(T* p) noexcept { set(p); }
+    offset_ptr(const offset_ptr& src) noexcept { set(src.get()); }
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    offset_ptr(const offset_ptr<U>& src) noexcept { set(src.get()); }
+
+    // pointer to void is cast explicitly as raw pointer is
+    template <typename U, typename = std::enable_if_t<!std::is_convertible_v<U*, T*> &&
+                                                      std::is_void_v<std::remove_cv_t<U>>>, typename = void>
+    explicit offset_ptr(const offset_ptr<U>& src) noexcept { set(static_cast<T*>(src.get())); }
+
+    offset_ptr& operator= (const offset_ptr& rhs) noexcept {
+        set(rhs.get());
+        return *this;
+    }
+
+    offset_ptr& operator= (T* p) noexcept {
+        set(p);
+        return *this;
+    }
+
+    offset_ptr& operator= (std::nullptr_t) noexcept {
+        off_ = null_off;
+        return *this;
+    }
+
+    template <typename U = T>
+    static offset_ptr pointer_to(ref_t<U> r) noexcept { return offset_ptr(std::addressof(r)); }
+
+    T* get() const noexcept {
+        return off_ == null_off ? nullptr
+                                : reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(this) + off_);
+    }
+
+    template <typename U = T>
+    ref_t<U> operator* () const { return *get(); }
+    T* operator-> () const { return get(); }
+
+    template <typename U = T>
+    ref_t<U> operator[] (difference_type i) const { return get()[i]; }
+
+    explicit operator bool () const noexcept { return off_ != null_off; }
+
+    offset_ptr& operator+= (difference_type d) { return *this = get() + d; }
+    offset_ptr& operator-= (difference_type d) { return *this = get() - d; }
+    offset_ptr& operator++ () { return *this += 1; }
+    offset_ptr& operator-- () { return *this -= 1; }
+
+    offset_ptr operator++ (int) {
+        auto ret = *this;
+        ++*this;
+        return ret;
+    }
+
+    offset_ptr operator-- (int) {
+        auto ret = *this;
+        --*this;
+        return ret;
+    }
+
+    friend offset_ptr operator+ (const offset_ptr& p, difference_type d) { return p.get() + d; }
+    friend offset_ptr operator+ (difference_type d, const offset_ptr& p) { return p.get() + d; }
+    friend offset_ptr operator- (const offset_ptr& p, difference_type d) { return p.get() - d; }
+    friend difference_type operator- (const offset_ptr& lhs, const offset_ptr& rhs) { return lhs.get() - rhs.get(); }
+
+    friend bool operator== (const offset_ptr& lhs, const offset_ptr& rhs) { return lhs.get() == rhs.get(); }
+    friend bool operator!= (const offset_ptr& lhs, const offset_ptr& rhs) { return lhs.get() != rhs.get(); }
+    friend bool operator< (const offset_ptr& lhs, const offset_ptr& rhs) { return lhs.get() < rhs.get(); }
+    friend bool operator> (const offset_ptr& lhs, const offset_ptr& rhs) { return lhs.get() > rhs.get(); }
+    friend bool operator<= (const offset_ptr& lhs, const offset_ptr& rhs) { return lhs.get() <= rhs.get(); }
+    friend bool operator>= (const offset_ptr& lhs, const offset_ptr& rhs) { return lhs.get() >= rhs.get(); }
+
+    friend bool operator== (const offset_ptr& lhs, std::nullptr_t) { return !lhs; }
+    friend bool operator!= (const offset_ptr& lhs, std::nullptr_t) { return bool(lhs); }
+    friend bool operator== (std::nullptr_t, const offset_ptr& rhs) { return !rhs; }
+    friend bool operator!= (std::nullptr_t, const offset_ptr& rhs) { return bool(rhs); }
+
+private:
+    static constexpr difference_type null_off = 1;
+
+    void set(const volatile void* p) noexcept {
+        off_ = p == nullptr ? null_off
+                            : static_cast<difference_type>(reinterpret_cast<uintptr_t>(p) -
+                                                           reinterpret_cast<uintptr_t>(this));
+    }
+
+private:
+    difference_type off_ = {null_off};
+};
+
+} // namespace griha
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+namespace griha {
+
+// Fixed set of worker threads running indexed tasks.
+// Calling thread takes part in every run, so pool of size 1 has no workers at all.
+class thread_pool {
+public:
+    explicit thread_pool(size_t threads = std::thread::hardware_concurrency()) {
+        for (size_t i = 1; i < threads; ++i)
+            workers_.emplace_back([this] { work(); });
+    }
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& w : workers_)
+            w.join();
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator= (const thread_pool&) = delete;
+
+    size_t size() const { return workers_.size() + 1; }
+
+    // Calls f(i) for every i in [0, n) and returns when all calls are completed.
+    // Tasks are taken one by one, so uneven tasks are balanced between threads.
+    // The first exception thrown by tasks is rethrown, remaining tasks are skipped.
+    template <typename F>
+    void run(size_t n, F&& f) {
+        std::lock_guard<std::mutex> run_lock(run_m_);
+
+        std::atomic<size_t> next = {0};
+        std::exception_ptr error;
+        std::mutex error_m;
+        std::function<void()> job = [&] {
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n;) {
+                try {
+                    f(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_m);
+                    if (!error)
+                        error = std::current_exception();
+                    next.store(n, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            job_ = &job;
+            busy_ = workers_.size();
+            ++generation_;
+        }
+        wake_.notify_all();
+        job();
+        {
+            std::unique_lock<std::mutex> lock(m_);
+            done_.wait(lock, [this] { return busy_ == 0; });
+            job_ = nullptr;
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    void work() {
+        size_t seen = 0;
+        std::unique_lock<std::mutex> lock(m_);
+        for (;;) {
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_)
+                return;
+            seen = generation_;
+            auto job = job_;
+            lock.unlock();
+            (*job)();
+            lock.lock();
+            if (--busy_ == 0)
+                done_.notify_one();
+        }
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex run_m_; // runs of different threads are serialized
+    std::mutex m_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void()>* job_ = {nullptr};
+    size_t generation_ = {0};
+    size_t busy_ = {0};
+    bool stop_ = {false};
+};
+
+// Skip markers splitting list into consecutive non-empty segments of about equal length.
+// Markers are found by one sequential walk and stay valid while no marked element is erased,
+// so they are computed once for any number of read-only passes.
+template <typename Iterator>
+class list_segments {
+public:
+    using iterator = Iterator;
+
+public:
+    template <typename List>
+    list_segments(List& l, size_t n) {
+        auto size = static_cast<size_t>(l.size());
+        n = std::max(std::min(n, size), size_t(1));
+        auto step = size / n, extra = size % n;
+
+        markers_.reserve(n + 1);
+        auto it = iterator(l.begin());
+        for (size_t i = 0; i < n && size != 0; ++i) {
+            markers_.push_back(it);
+            std::advance(it, step + (i < extra ? 1 : 0));
+        }
+        markers_.push_back(iterator(l.end()));
+    }
+
+    size_t size() const { return markers_.size() - 1; }
+
+    iterator begin(size_t i) const { return markers_[i]; }
+    iterator end(size_t i) const { return markers_[i + 1]; }
+
+private:
+    std::vector<iterator> markers_;
+};
+
+template <typename List>
+list_segments<decltype(std::declval<List&>().begin())> split(List& l, size_t n) {
+    return {l, n};
+}
+
+// Parallel algorithms over segments of lists.
+// Segments are processed as independent tasks of thread pool, so their number should be
+// a few times larger than size of pool to balance threads. Overloads taking list split it
+// on every call, which is a sequential walk over the whole list.
+
+namespace parallel {
+
+// segments per thread of pool by default
+constexpr size_t oversubscription = 4;
+
+template <typename Iterator, typename F>
+void for_each(thread_pool& pool, const list_segments<Iterator>& segments, F f) {
+    pool.run(segments.size(), [&] (size_t i) {
+        std::for_each(segments.begin(i), segments.end(i), f);
+    });
+}
+
+// partial results of segments are reduced in list order, so reduce should be associative only
+template <typename Iterator, typename T, typename Reduce, typename Transform>
+T transform_reduce(thread_pool& pool, const list_segments<Iterator>& segments,
+                   T init, Reduce reduce, Transform transform) {
+    std::vector<T> partial(segments.size(), init);
+    std::vector<char> has_partial(segments.size(), 0);
+    pool.run(segments.size(), [&] (size_t i) {
+        auto first = segments.begin(i), last = segments.end(i);
+        if (first == last)
+            return;
+        T acc = transform(*first);
+        for (++first; first != last; ++first)
+            acc = reduce(std::move(acc), transform(*first));
+        partial[i] = std::move(acc);
+        has_partial[i] = 1;
+    });
+
+    for (size_t i = 0; i < partial.size(); ++i)
+        if (has_partial[i])
+            init = reduce(std::move(init), std::move(partial[i]));
+    return init;
+}
+
+template <typename Iterator, typename Predicate>
+size_t count_if(thread_pool& pool, const list_segments<Iterator>& segments, Predicate pred) {
+    return transform_reduce(pool, segments, size_t(0), std::plus<>(),
+                            [&pred] (const auto& v) -> size_t { return pred(v) ? 1 : 0; });
+}
+
+template <typename List, typename F,
+          typename = decltype(std::declval<List&>().begin())>
+void for_each(thread_pool& pool, List& l, F f) {
+    for_each(pool, split(l, pool.size() * oversubscription), std::move(f));
+}
+
+template <typename List, typename T, typename Reduce, typename Transform,
+          typename = decltype(std::declval<List&>().begin())>
+T transform_reduce(thread_pool& pool, List& l, T init, Reduce reduce, Transform transform) {
+    return transform_reduce(pool, split(l, pool.size() * oversubscription),
+                            std::move(init), std::move(reduce), std::move(transform));
+}
+
+template <typename List, typename Predicate,
+          typename = decltype(std::declval<List&>().begin())>
+size_t count_if(thread_pool& pool, List& l, Predicate pred) {
+    return count_if(pool, split(l, pool.size() * oversubscription), std::move(pred));
+}
+
+} // namespace parallel
+
+} // namespace griha
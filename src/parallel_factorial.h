@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+#include "big_integer.h"
+#include "factorial.h"
+#include "parallel.h"
+
+namespace griha {
+
+namespace details {
+
+// Subtrees of product tree are evaluated as tasks of pool, then their results are multiplied
+// by pairs in parallel rounds. The last multiplication is done by one thread.
+inline big_uint product(const std::vector<uint64_t>& words, thread_pool& pool) {
+    auto tasks = std::min(words.size(), pool.size() * parallel::oversubscription);
+    if (tasks < 2)
+        return product(words.data(), words.data() + words.size());
+
+    std::vector<big_uint> parts(tasks);
+    pool.run(tasks, [&] (size_t i) {
+        parts[i] = product(words.data() + words.size() * i / tasks,
+                           words.data() + words.size() * (i + 1) / tasks);
+    });
+
+    while (parts.size() > 1) {
+        std::vector<big_uint> next((parts.size() + 1) / 2);
+        pool.run(next.size(), [&] (size_t i) {
+            next[i] = 2 * i + 1 < parts.size() ? parts[2 * i] * parts[2 * i + 1] : std::move(parts[2 * i]);
+        });
+        parts = std::move(next);
+    }
+    return std::move(parts.front());
+}
+
+} // namespace details
+
+// exact factorial computed by threads of pool
+inline big_uint big_fact(unsigned value, thread_pool& pool) {
+    return details::product(details::factorial_words(value), pool);
+}
+
+} // namespace griha
@@ -0,0 +1,425 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <cerrno>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "offset_ptr.h"
+
+namespace griha {
+
+namespace details {
+
+// writes pages of range to file synchronously
+inline void flush_range(const void* p, size_t size) {
+    auto page = reinterpret_cast<uintptr_t>(p) & ~uintptr_t(sysconf(_SC_PAGESIZE) - 1);
+    msync(reinterpret_cast<void*>(page), reinterpret_cast<uintptr_t>(p) + size - page, MS_SYNC);
+}
+
+// Segment is the content of file of persistent_arena mapped at any address. It starts
+// with header followed by blocks, all references inside the segment are offsets from its start.
+// Blocks are carved from the top of used space and are returned into free lists
+// by size classes (or into list of large blocks), freed block keeps offset of the next one.
+// Links of free lists of committed state are lost once their blocks are reused and overwritten,
+// so the first reuse after commit is marked durably and recovery drops free lists of such commit,
+// blocks kept in them are leaked.
+class persistent_segment {
+public:
+    static constexpr uint64_t magic_value = 0x31414e4552414847ull; // "GHARENA1"
+    static constexpr uint64_t version_value = 2;
+
+    static constexpr size_t block_alignment = 16;
+    static constexpr size_t max_class_size = 1024;
+    static constexpr size_t class_count = max_class_size / block_alignment;
+    static constexpr size_t max_roots = 16;
+    static constexpr size_t max_name = 32;
+
+    struct root {
+        char name[max_name];
+        uint64_t offset; // 0 for empty entry
+        uint64_t size;   // size of object checked on lookup
+    };
+
+    // Allocation state is kept live and in two committed copies written alternately,
+    // so crash during commit leaves the previous one intact.
+    struct state {
+        uint64_t sequence;
+        uint64_t top;
+        uint64_t free[class_count];
+        uint64_t large_free;
+        root roots[max_roots];
+        uint64_t checksum;
+    };
+
+public:
+    void init(uint64_t capacity) {
+        memset(static_cast<void*>(this), 0, sizeof(*this));
+        magic_ = magic_value;
+        version_ = version_value;
+        capacity_ = capacity;
+        live_.top = data_offset();
+    }
+
+    // restores live state from the last valid commit, false if there is none
+    bool recover(uint64_t file_size) {
+        if (magic_ != magic_value || version_ != version_value || capacity_ != file_size)
+            return false;
+
+        const state* last = nullptr;
+        for (auto& s : committed_)
+            if (s.checksum == checksum(s) && (last == nullptr || s.sequence > last->sequence))
+                last = &s;
+        if (last == nullptr || last->top < data_offset() || last->top > capacity_)
+            return false;
+        live_ = *last;
+        if (reused_ == live_.sequence) {
+            std::fill(std::begin(live_.free), std::end(live_.free), 0);
+            live_.large_free = 0;
+        }
+        return true;
+    }
+
+    // copies live state into the older committed slot, returns range of bytes to flush
+    std::pair<const void*, size_t> commit() {
+        ++live_.sequence;
+        live_.checksum = checksum(live_);
+        auto& slot = committed_[live_.sequence % 2];
+        slot = live_;
+        return {&slot, sizeof(slot)};
+    }
+
+    void* allocate(size_t bytes) {
+        bytes = round(bytes);
+        if (bytes <= max_class_size) {
+            auto& head = live_.free[bytes / block_alignment - 1];
+            if (head != 0) {
+                mark_reused();
+                return pop(head);
+            }
+        } else if (auto p = take_large(bytes))
+            return p;
+
+        if (capacity_ - live_.top < bytes)
+            throw std::bad_alloc();
+        auto ret = at(live_.top);
+        live_.top += bytes;
+        return ret;
+    }
+
+    void deallocate(void* p, size_t bytes) {
+        bytes = round(bytes);
+        if (bytes <= max_class_size)
+            push(live_.free[bytes / block_alignment - 1], p);
+        else {
+            push(live_.large_free, p);
+            memcpy(static_cast<char*>(p) + sizeof(uint64_t), &bytes, sizeof(bytes));
+        }
+    }
+
+    root* find_root(const char* name) {
+        for (auto& r : live_.roots)
+            if (r.offset != 0 && strncmp(r.name, name, max_name) == 0)
+                return &r;
+        return nullptr;
+    }
+
+    root& add_root(const char* name, void* p, size_t size) {
+        if (strlen(name) >= max_name)
+            throw std::invalid_argument("name of root is too long");
+        if (find_root(name) != nullptr)
+            throw std::invalid_argument("root already exists");
+        for (auto& r : live_.roots) {
+            if (r.offset != 0)
+                continue;
+            memset(r.name, 0, max_name);
+            memcpy(r.name, name, strlen(name));
+            r.offset = offset_of(p);
+            r.size = size;
+            return r;
+        }
+        throw std::length_error("no free entries for roots");
+    }
+
+    void* at(uint64_t offset) { return reinterpret_cast<char*>(this) + offset; }
+    uint64_t offset_of(const void* p) const {
+        return static_cast<uint64_t>(static_cast<const char*>(p) - reinterpret_cast<const char*>(this));
+    }
+
+    uint64_t capacity() const { return capacity_; }
+    uint64_t used() const { return live_.top; }
+    uint64_t sequence() const { return live_.sequence; }
+
+    static constexpr uint64_t data_offset() { return (sizeof(persistent_segment) + 4095) / 4096 * 4096; }
+
+private:
+    static size_t round(size_t bytes) {
+        if (bytes > std::numeric_limits<size_t>::max() - block_alignment)
+            throw std::bad_alloc();
+        return std::max((bytes + block_alignment - 1) / block_alignment, size_t(1)) * block_alignment;
+    }
+
+    // FNV-1a of state except checksum
+    static uint64_t checksum(const state& s) {
+        auto p = reinterpret_cast<const unsigned char*>(&s);
+        uint64_t ret = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < offsetof(state, checksum); ++i)
+            ret = (ret ^ p[i]) * 0x100000001b3ull;
+        return ret;
+    }
+
+    void push(uint64_t& head, void* p) {
+        memcpy(p, &head, sizeof(head));
+        head = offset_of(p);
+    }
+
+    void mark_reused() {
+        if (reused_ == live_.sequence)
+            return;
+        reused_ = live_.sequence;
+        flush_range(&reused_, sizeof(reused_));
+    }
+
+    void* pop(uint64_t& head) {
+        auto ret = at(head);
+        memcpy(&head, ret, sizeof(head));
+        return ret;
+    }
+
+    // the first large block fitting bytes, rest of it is returned as free block
+    void* take_large(size_t bytes) {
+        for (auto prev = &live_.large_free; *prev != 0;) {
+            auto p = static_cast<char*>(at(*prev));
+            uint64_t size;
+            memcpy(&size, p + sizeof(uint64_t), sizeof(size));
+            if (size < bytes) {
+                prev = reinterpret_cast<uint64_t*>(p);
+                continue;
+            }
+            mark_reused();
+            pop(*prev);
+            if (size > bytes)
+                deallocate(p + bytes, size - bytes);
+            return p;
+        }
+        return nullptr;
+    }
+
+private:
+    uint64_t magic_;
+    uint64_t version_;
+    uint64_t capacity_;
+    uint64_t reused_; // sequence of the last commit whose free blocks were reused
+    state live_;
+    state committed_[2];
+};
+
+} // namespace details
+
+// Arena in memory-mapped file. Objects allocated in it are linked by offset pointers
+// (see persistent_allocator), so the file is mapped at any address by another process
+// or later run and named root objects are used at once without rebuilding.
+// The whole capacity is mapped up front as sparse file, pages take disk space on first touch.
+// Allocation metadata is crash consistent: sync() writes data and then commits metadata
+// into one of two checksummed copies, reopened arena gets state of the last complete commit.
+// Content of blocks is not versioned, objects modified after the last sync() may be torn.
+// Blocks free at the last sync() are leaked after crash if any free block was reused since.
+// File should be opened by one arena at a time, it is not thread-safe.
+class persistent_arena {
+public:
+    // opens existing file or creates new one of capacity bytes
+    persistent_arena(const std::string& path, size_t capacity) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0)
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+
+        try {
+            struct stat st;
+            if (fstat(fd_, &st) != 0)
+                throw std::system_error(errno, std::generic_category(), "stat " + path);
+            created_ = st.st_size == 0;
+            if (created_) {
+                capacity = std::max(capacity, size_t(details::persistent_segment::data_offset()));
+                if (ftruncate(fd_, static_cast<off_t>(capacity)) != 0)
+                    throw std::system_error(errno, std::generic_category(), "truncate " + path);
+            } else
+                capacity = static_cast<size_t>(st.st_size);
+
+            size_ = capacity;
+            auto p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+            if (p == MAP_FAILED)
+                throw std::system_error(errno, std::generic_category(), "mmap " + path);
+            segment_ = static_cast<details::persistent_segment*>(p);
+
+            if (created_) {
+                segment_->init(size_);
+                sync();
+            } else if (size_ < sizeof(*segment_) || !segment_->recover(size_))
+                throw std::runtime_error("no valid arena in " + path);
+        } catch (...) {
+            close();
+            throw;
+        }
+    }
+
+    persistent_arena(const persistent_arena&) = delete;
+    persistent_arena& operator= (const persistent_arena&) = delete;
+
+    ~persistent_arena() {
+        sync();
+        close();
+    }
+
+    // false if the file existed before
+    bool created() const { return created_; }
+
+    void* allocate(size_t bytes) { return segment_->allocate(bytes); }
+    void deallocate(void* p, size_t bytes) { segment_->deallocate(p, bytes); }
+
+    // allocates and constructs named root object, name should be unique
+    template <typename T, typename... Args>
+    T& construct(const char* name, Args&&... args) {
+        auto p = allocate(sizeof(T));
+        T* ret;
+        try {
+            ret = ::new(p) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(p, sizeof(T));
+            throw;
+        }
+        try {
+            segment_->add_root(name, ret, sizeof(T));
+        } catch (...) {
+            ret->~T();
+            deallocate(p, sizeof(T));
+            throw;
+        }
+        return *ret;
+    }
+
+    // root object of type T or nullptr if there is no root of the name
+    template <typename T>
+    T* find(const char* name) {
+        auto r = segment_->find_root(name);
+        if (r == nullptr)
+            return nullptr;
+        if (r->size != sizeof(T))
+            throw std::invalid_argument("root is of another type");
+        return static_cast<T*>(segment_->at(r->offset));
+    }
+
+    template <typename T>
+    void destroy(const char* name) {
+        auto p = find<T>(name);
+        if (p == nullptr)
+            return;
+        p->~T();
+        deallocate(p, sizeof(T));
+        segment_->find_root(name)->offset = 0;
+    }
+
+    // Data is flushed before metadata, so committed metadata never refers to unwritten blocks.
+    void sync() {
+        if (segment_ == nullptr)
+            return;
+        msync(segment_, size_, MS_SYNC);
+        auto range = segment_->commit();
+        details::flush_range(range.first, range.second);
+    }
+
+    size_t capacity() const { return size_; }
+    size_t used() const { return segment_->used(); }
+
+    details::persistent_segment* segment() const { return segment_; }
+
+private:
+    void close() {
+        if (segment_ != nullptr)
+            munmap(segment_, size_);
+        segment_ = nullptr;
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+    }
+
+private:
+    int fd_ = {-1};
+    size_t size_ = {0};
+    bool created_ = {false};
+    details::persistent_segment* segment_ = {nullptr};
+};
+
+// Allocator of persistent_arena with offset pointers, so containers using it
+// (as bidirectional_list) may be placed in the arena and reopened at another address.
+// It refers to segment by offset pointer too, so it stays valid inside the segment.
+template <typename T>
+class persistent_allocator {
+    static_assert(alignof(T) <= details::persistent_segment::block_alignment, "T is over-aligned");
+
+public:
+    using value_type = T;
+    using pointer = offset_ptr<T>;
+    using const_pointer = offset_ptr<const T>;
+    using void_pointer = offset_ptr<void>;
+    using const_void_pointer = offset_ptr<const void>;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+    template <typename U>
+    struct rebind {
+        using other = persistent_allocator<U>;
+    };
+
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+public:
+    explicit persistent_allocator(persistent_arena& arena) : segment_(arena.segment()) {}
+
+    persistent_allocator(const persistent_allocator&) = default;
+    persistent_allocator& operator= (const persistent_allocator&) = default;
+
+    template <typename U>
+    persistent_allocator(const persistent_allocator<U>& other) : segment_(other.segment()) {}
+
+    pointer allocate(size_type n) {
+        if (n > std::numeric_limits<size_type>::max() / sizeof(T))
+            throw std::bad_alloc();
+        return pointer(static_cast<T*>(segment_->allocate(n * sizeof(T))));
+    }
+
+    void deallocate(pointer p, size_type n) { segment_->deallocate(p.get(), n * sizeof(T)); }
+
+    details::persistent_segment* segment() const { return segment_.get(); }
+
+    template <typename U>
+    friend bool operator== (const persistent_allocator& lhs, const persistent_allocator<U>& rhs) {
+        return lhs.segment() == rhs.segment();
+    }
+
+    template <typename U>
+    friend bool operator!= (const persistent_allocator& lhs, const persistent_allocator<U>& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    offset_ptr<details::persistent_segment> segment_;
+};
+
+} // namespace griha
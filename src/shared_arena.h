@@ -0,0 +1,140 @@
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+#include "allocator.h"
+
+namespace griha {
+
+// Arenas shared by allocators of all types rebound from each other.
+// Elements of equal size and alignment share arena, it is created on the first request.
+template <size_t ChunkN, typename ReclaimPolicy, typename GrowthPolicy, typename UpstreamSource>
+class arena_group {
+    template <size_t Size, size_t Align>
+    struct alignas(Align) slot {
+        unsigned char bytes[Size];
+    };
+
+public:
+    template <size_t Size, size_t Align>
+    using arena = allocator_arena<slot<Size, Align>, ChunkN, ReclaimPolicy, GrowthPolicy, UpstreamSource>;
+
+public:
+    explicit arena_group(size_t chunk_n = ChunkN) : chunk_n_(chunk_n) {}
+
+    arena_group(const arena_group&) = delete;
+    arena_group& operator= (const arena_group&) = delete;
+
+    template <size_t Size, size_t Align>
+    arena<Size, Align>& get() {
+        for (auto& e : arenas_)
+            if (e.size == Size && e.align == Align)
+                return *static_cast<arena<Size, Align>*>(e.arena.get());
+
+        arenas_.reserve(arenas_.size() + 1);
+        holder h(new arena<Size, Align>(chunk_n_), [] (void* p) { delete static_cast<arena<Size, Align>*>(p); });
+        auto& ret = *static_cast<arena<Size, Align>*>(h.get());
+        arenas_.push_back({Size, Align, std::move(h)});
+        return ret;
+    }
+
+    size_t arena_count() const { return arenas_.size(); }
+
+private:
+    using holder = std::unique_ptr<void, void (*)(void*)>;
+
+    struct entry {
+        size_t size;
+        size_t align;
+        holder arena;
+    };
+
+private:
+    size_t chunk_n_;
+    std::vector<entry> arenas_;
+};
+
+// Allocator handle with shared ownership of arena group.
+// Copies and rebound conversions refer to the same group and compare equal, so containers
+// built from one handle move, swap and splice nodes between each other in O(1).
+// The group is released with the last handle. As allocator_arena it is not thread-safe,
+// containers sharing group should be used by one thread at a time.
+template <typename T,
+          size_t ChunkN = 1024ul,
+          typename ReclaimPolicy = reclaim_keep_spare<1>,
+          typename GrowthPolicy = grow_fixed,
+          typename UpstreamSource = malloc_source>
+class shared_arena_allocator {
+    template <typename, size_t, typename, typename, typename> friend class shared_arena_allocator;
+
+public:
+    using group_type = arena_group<ChunkN, ReclaimPolicy, GrowthPolicy, UpstreamSource>;
+
+private:
+    using arena_type = typename group_type::template arena<sizeof(T), alignof(T)>;
+    using slot_type = typename arena_type::value_type;
+
+public:
+    template <typename U>
+    struct rebind {
+        using other = shared_arena_allocator<U, ChunkN, ReclaimPolicy, GrowthPolicy, UpstreamSource>;
+    };
+
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+public:
+    // every default constructed handle owns new group
+    shared_arena_allocator() : shared_arena_allocator(std::make_shared<group_type>()) {}
+
+    explicit shared_arena_allocator(std::shared_ptr<group_type> group)
+        : group_(std::move(group)),
+          arena_(&group_->template get<sizeof(T), alignof(T)>()) {}
+
+    // no move operations, so moved-from handle keeps referring to its group
+    shared_arena_allocator(const shared_arena_allocator&) = default;
+    shared_arena_allocator& operator= (const shared_arena_allocator&) = default;
+
+    template <typename U>
+    shared_arena_allocator(const shared_arena_allocator<U, ChunkN, ReclaimPolicy, GrowthPolicy, UpstreamSource>& other)
+        : shared_arena_allocator(other.group_) {}
+
+    T* allocate(size_type n) { return reinterpret_cast<T*>(arena_->allocate(n)); }
+    void deallocate(T* p, size_type n) { arena_->deallocate(reinterpret_cast<slot_type*>(p), n); }
+
+    T* allocate_near(size_type n, const T* hint) {
+        return reinterpret_cast<T*>(arena_->allocate_near(n, reinterpret_cast<const slot_type*>(hint)));
+    }
+
+    size_type max_piecewise_size() const { return arena_->max_piecewise_size(); }
+
+    const std::shared_ptr<group_type>& group() const { return group_; }
+
+    template <typename U>
+    friend bool operator== (const shared_arena_allocator& lhs,
+                            const shared_arena_allocator<U, ChunkN, ReclaimPolicy, GrowthPolicy, UpstreamSource>& rhs) {
+        return lhs.group() == rhs.group();
+    }
+
+    template <typename U>
+    friend bool operator!= (const shared_arena_allocator& lhs,
+                            const shared_arena_allocator<U, ChunkN, ReclaimPolicy, GrowthPolicy, UpstreamSource>& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    std::shared_ptr<group_type> group_;
+    arena_type* arena_;
+};
+
+} // namespace griha
@@ -0,0 +1,369 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace griha {
+
+// Unrolled doubly linked list keeping up to NodeN elements in every node.
+// Traversal steps through contiguous elements of node and follows link once per node.
+// Insertion splits full node in halves. Node left less than half full by erasure takes elements
+// of a neighbour or is merged with it, so erasure keeps nodes at least half full.
+// Both stay amortized O(1). In contrast to bidirectional_list, insertion and erasure
+// invalidate iterators to elements of affected nodes.
+template <typename T, size_t NodeN = 16, typename Alloc = std::allocator<T>>
+class unrolled_list {
+    static_assert(NodeN >= 2, "node should keep at least two elements");
+
+public:
+    using value_type = T;
+    using reference = T&;
+    using const_reference = const T&;
+
+private:
+    struct node {
+        node* prev;
+        node* next;
+        size_t count;
+        alignas(T) unsigned char storage[NodeN * sizeof(T)];
+
+        T* values() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    template <bool Const>
+    class iterator_inner {
+        template <typename, size_t, typename> friend class unrolled_list;
+        friend class iterator_inner<!Const>;
+
+        using list_type = std::conditional_t<!Const, unrolled_list, const unrolled_list>;
+
+    public:
+        using value_type = unrolled_list::value_type;
+        using reference = std::conditional_t<!Const, T&, const T&>;
+        using pointer = std::conditional_t<!Const, T*, const T*>;
+        using difference_type = ptrdiff_t;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+    public:
+        iterator_inner(const iterator_inner&) = default;
+        iterator_inner& operator=(const iterator_inner&) = default;
+
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        iterator_inner(const iterator_inner<false>& src) : list_(src.list_), n_(src.n_), i_(src.i_) {}
+
+        reference operator* () const { return n_->values()[i_]; }
+        pointer operator-> () const { return &n_->values()[i_]; }
+
+        iterator_inner& operator++ () {
+            if (n_ != nullptr && ++i_ == n_->count) {
+                n_ = n_->next;
+                i_ = 0;
+            }
+            return *this;
+        }
+
+        iterator_inner operator++ (int) {
+            auto ret = *this;
+            ++(*this);
+            return ret;
+        }
+
+        iterator_inner& operator-- () {
+            if (n_ == nullptr || i_ == 0) {
+                n_ = n_ != nullptr ? n_->prev : list_->tail_;
+                i_ = n_ != nullptr ? n_->count - 1 : 0;
+            } else
+                --i_;
+            return *this;
+        }
+
+        iterator_inner operator-- (int) {
+            auto ret = *this;
+            --(*this);
+            return ret;
+        }
+
+        friend
+        bool operator== (const iterator_inner& lhs, const iterator_inner& rhs) {
+            return lhs.n_ == rhs.n_ && lhs.i_ == rhs.i_;
+        }
+
+        friend
+        bool operator!= (const iterator_inner& lhs, const iterator_inner& rhs) {
+            return !(lhs == rhs);
+        }
+
+    private:
+        iterator_inner(list_type* list, node* n, size_t i) : list_(list), n_(n), i_(i) {}
+
+    private:
+        list_type* list_;
+        node* n_;
+        size_t i_;
+    };
+
+    using alloc_type = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+    using alloc_traits = std::allocator_traits<alloc_type>;
+
+public:
+    using iterator = iterator_inner<false>;
+    using const_iterator = iterator_inner<true>;
+
+    using pointer = typename std::allocator_traits<Alloc>::pointer;
+    using const_pointer = typename std::allocator_traits<Alloc>::const_pointer;
+    using difference_type = ptrdiff_t;
+    using size_type = size_t;
+
+    using allocator_type = Alloc;
+
+    static constexpr size_type node_capacity = NodeN;
+
+public:
+    unrolled_list() {}
+    explicit unrolled_list(const Alloc& alloc) : alloc_(alloc) {}
+    ~unrolled_list() { clear(); }
+
+    unrolled_list(const unrolled_list& src) {
+        for (auto& v : src)
+            emplace(end(), v);
+    }
+
+    unrolled_list(unrolled_list&& src) {
+        swap(src);
+    }
+
+    unrolled_list& operator= (const unrolled_list& rhs) {
+        unrolled_list t(rhs);
+        swap(t);
+        return *this;
+    }
+
+    unrolled_list& operator= (unrolled_list&& rhs) {
+        swap(rhs);
+        return *this;
+    }
+
+    iterator begin() { return iterator(this, head_, 0); }
+    const_iterator begin() const { return const_iterator(this, head_, 0); }
+    const_iterator cbegin() const { return const_iterator(this, head_, 0); }
+
+    iterator end() { return iterator(this, nullptr, 0); }
+    const_iterator end() const { return const_iterator(this, nullptr, 0); }
+    const_iterator cend() const { return const_iterator(this, nullptr, 0); }
+
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        auto n = pos.n_;
+        auto i = pos.i_;
+        if (n == nullptr) {
+            n = tail_;
+            i = n != nullptr ? n->count : 0;
+        }
+
+        if (n == nullptr) {
+            n = insert_node(nullptr);
+            construct(n, 0, std::forward<Args>(args)...);
+            n->count = 1;
+            ++size_;
+            return iterator(this, n, 0);
+        }
+
+        if (n->count == NodeN) {
+            if (i == NodeN && (n->next == nullptr || n->next->count == NodeN)) {
+                // appending after full node starts new one, so sequential filling keeps nodes full
+                n = insert_node(n);
+                i = 0;
+            } else if (i == NodeN) {
+                n = n->next;
+                i = 0;
+            } else {
+                auto half = split(n);
+                if (i > NodeN / 2) {
+                    n = half;
+                    i -= NodeN / 2;
+                }
+            }
+        }
+
+        insert_at(n, i, std::forward<Args>(args)...);
+        ++size_;
+        return iterator(this, n, i);
+    }
+
+    // returns iterator following erased element
+    iterator erase(const_iterator pos) {
+        auto n = pos.n_;
+        if (n == nullptr)
+            return end();
+        auto i = pos.i_;
+
+        auto values = n->values();
+        std::move(values + i + 1, values + n->count, values + i);
+        destroy(n, --n->count);
+        --size_;
+
+        if (n->count == 0) {
+            auto next = n->next;
+            remove_node(n);
+            return iterator(this, next, 0);
+        }
+
+        // the successor is preferred, the tail turns to its predecessor
+        if (n->count < NodeN / 2) {
+            if (auto next = n->next) {
+                if (n->count + next->count <= NodeN)
+                    merge_next(n);
+                else
+                    borrow_next(n, NodeN / 2 - n->count);
+            } else if (auto prev = n->prev) {
+                if (prev->count + n->count <= NodeN) {
+                    i += prev->count;
+                    merge_next(prev);
+                    n = prev;
+                } else {
+                    auto k = NodeN / 2 - n->count;
+                    borrow_prev(n, k);
+                    i += k;
+                }
+            }
+        }
+
+        if (i == n->count)
+            return iterator(this, n->next, 0);
+        return iterator(this, n, i);
+    }
+
+    void clear() {
+        for (auto n = head_; n != nullptr;) {
+            auto next = n->next;
+            for (size_t i = 0; i < n->count; ++i)
+                destroy(n, i);
+            alloc_traits::deallocate(alloc_, n, 1ul);
+            n = next;
+        }
+        head_ = tail_ = nullptr;
+        size_ = 0;
+    }
+
+    allocator_type get_allocator() const { return allocator_type(alloc_); }
+
+    size_type size() const { return size_; }
+    size_type max_size() const { return std::numeric_limits<size_type>::max(); }
+
+    bool empty() const { return head_ == nullptr; }
+
+    void swap(unrolled_list& other) {
+        std::swap(alloc_, other.alloc_);
+        std::swap(head_, other.head_);
+        std::swap(tail_, other.tail_);
+        std::swap(size_, other.size_);
+    }
+
+private:
+    template <typename... Args>
+    void construct(node* n, size_t i, Args&&... args) {
+        alloc_traits::construct(alloc_, n->values() + i, std::forward<Args>(args)...);
+    }
+
+    void destroy(node* n, size_t i) { alloc_traits::destroy(alloc_, n->values() + i); }
+
+    // links new empty node after n or at head if n is nullptr
+    node* insert_node(node* n) {
+        node* ret = alloc_traits::allocate(alloc_, 1ul);
+        ret->count = 0;
+        ret->prev = n;
+        ret->next = n != nullptr ? n->next : head_;
+        (ret->next != nullptr ? ret->next->prev : tail_) = ret;
+        (n != nullptr ? n->next : head_) = ret;
+        return ret;
+    }
+
+    void remove_node(node* n) {
+        (n->next != nullptr ? n->next->prev : tail_) = n->prev;
+        (n->prev != nullptr ? n->prev->next : head_) = n->next;
+        alloc_traits::deallocate(alloc_, n, 1ul);
+    }
+
+    // element is constructed in place at the end of node or moved into the gap
+    template <typename... Args>
+    void insert_at(node* n, size_t i, Args&&... args) {
+        if (i == n->count) {
+            construct(n, i, std::forward<Args>(args)...);
+        } else {
+            T value(std::forward<Args>(args)...);
+            auto values = n->values();
+            construct(n, n->count, std::move(values[n->count - 1]));
+            std::move_backward(values + i, values + n->count - 1, values + n->count);
+            values[i] = std::move(value);
+        }
+        ++n->count;
+    }
+
+    // moves upper half of full node into new node following it
+    node* split(node* n) {
+        auto ret = insert_node(n);
+        move_elements(n, NodeN / 2, n->count, ret);
+        return ret;
+    }
+
+    void merge_next(node* n) {
+        auto next = n->next;
+        move_elements(next, 0, next->count, n);
+        remove_node(next);
+    }
+
+    // moves k first elements of successor to the end of n
+    void borrow_next(node* n, size_t k) {
+        auto next = n->next;
+        auto values = next->values();
+        move_elements(next, 0, k, n);
+        for (size_t i = 0; i < next->count; ++i) {
+            construct(next, i, std::move(values[i + k]));
+            destroy(next, i + k);
+        }
+    }
+
+    // moves k last elements of predecessor to the front of n
+    void borrow_prev(node* n, size_t k) {
+        auto prev = n->prev;
+        auto values = n->values();
+        for (auto i = n->count; i-- != 0;) {
+            construct(n, i + k, std::move(values[i]));
+            destroy(n, i);
+        }
+        auto from = prev->values() + prev->count - k;
+        for (size_t i = 0; i < k; ++i) {
+            construct(n, i, std::move(from[i]));
+            destroy(prev, prev->count - k + i);
+        }
+        n->count += k;
+        prev->count -= k;
+    }
+
+    // moves elements [f, l) of src to the end of dst
+    void move_elements(node* src, size_t f, size_t l, node* dst) {
+        for (auto i = f; i < l; ++i) {
+            construct(dst, dst->count++, std::move(src->values()[i]));
+            destroy(src, i);
+        }
+        src->count -= l - f;
+    }
+
+private:
+    alloc_type alloc_;
+    node* head_ = {nullptr};
+    node* tail_ = {nullptr};
+    size_type size_ = {0};
+};
+
+template <typename T, size_t NodeN, typename Alloc>
+void swap(unrolled_list<T, NodeN, Alloc>& lhs, unrolled_list<T, NodeN, Alloc>& rhs) {
+    lhs.swap(rhs);
+}
+
+} // namespace griha
@@ -1,5 +1,10 @@
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
 #include <allocator.h>
 
 #include "utils.h"
@@ -62,6 +67,266 @@ TEST_CASE("deallocation") {
         auto p4 = alloc.allocate(1ul); // now it allocates in old chunk
         REQUIRE(&p2[1ul] == p4); // p4 should be next after end of p2
     }
+
+    SECTION("deallocation in any of chunks") {
+        int* ps[5];
+        for (auto& p : ps)
+            p = alloc.allocate(10ul); // each allocation occupies whole chunk
+        alloc.deallocate(&ps[1][3], 4ul);
+        alloc.deallocate(&ps[3][0], 2ul);
+        REQUIRE(alloc.allocate(2ul) == ps[3]);
+        REQUIRE(alloc.allocate(3ul) == &ps[1][3]);
+        REQUIRE(alloc.allocate(1ul) == &ps[1][6]);
+    }
+}
+
+TEST_CASE("placement policies") {
+    SECTION("best fit keeps longer runs for longer sequences") {
+        allocator_arena<int, 10ul, reclaim_never, grow_fixed, malloc_source, no_stats, first_fit> first;
+        allocator_arena<int, 10ul, reclaim_never, grow_fixed, malloc_source, no_stats, best_fit> best;
+
+        auto fragment = [] (auto& alloc) {
+            auto p1 = alloc.allocate(10ul);
+            auto p2 = alloc.allocate(10ul);
+            alloc.deallocate(p2, 2ul);
+            alloc.deallocate(p1, 4ul);
+            return make_pair(p1, p2);
+        };
+
+        auto [f1, f2] = fragment(first);
+        REQUIRE(first.allocate(2ul) == f1); // the most recently freed chunk
+        first.allocate(4ul);
+        REQUIRE_THAT(first.chunk_count(), Equals(3ul));
+
+        auto [b1, b2] = fragment(best);
+        REQUIRE(best.allocate(2ul) == b2); // the shortest sufficient run
+        REQUIRE(best.allocate(4ul) == b1);
+        REQUIRE_THAT(best.chunk_count(), Equals(2ul));
+    }
+
+    SECTION("next fit continues in chunk of previous allocation") {
+        allocator_arena<int, 10ul, reclaim_never, grow_fixed, malloc_source, no_stats, next_fit> alloc;
+        int* ps[3];
+        for (auto& p : ps)
+            p = alloc.allocate(10ul);
+        alloc.deallocate(ps[0], 3ul);
+        alloc.deallocate(ps[2], 3ul);
+        REQUIRE(alloc.allocate(2ul) == ps[0]);
+        alloc.deallocate(ps[1], 3ul);
+        REQUIRE(alloc.allocate(1ul) == &ps[0][2]); // first fit would take the most recently freed chunk
+    }
+}
+
+TEST_CASE("single element allocation") {
+    allocator_arena<double, 10ul> alloc;
+    SECTION("freed elements are reused in LIFO order") {
+        auto p1 = alloc.allocate(1ul);
+        auto p2 = alloc.allocate(1ul);
+        auto p3 = alloc.allocate(1ul);
+        alloc.deallocate(p1, 1ul);
+        alloc.deallocate(p3, 1ul);
+        REQUIRE(alloc.allocate(1ul) == p3); // last freed is reused first
+        REQUIRE(alloc.allocate(1ul) == p1);
+        REQUIRE(alloc.allocate(1ul) == &p2[2ul]);
+    }
+
+    SECTION("freed elements are returned for sequence allocation") {
+        auto p1 = alloc.allocate(4ul);
+        auto p2 = alloc.allocate(1ul);
+        auto p3 = alloc.allocate(1ul);
+        alloc.allocate(4ul);
+        alloc.deallocate(p2, 1ul);
+        alloc.deallocate(p3, 1ul);
+        REQUIRE(alloc.allocate(2ul) == &p1[4ul]); // no new chunk is required
+    }
+
+    SECTION("free lists of chunks") {
+        auto p = alloc.allocate(10ul);
+        auto q = alloc.allocate(10ul);
+        alloc.deallocate(&p[1], 1ul);
+        alloc.deallocate(&q[1], 1ul);
+        alloc.deallocate(&p[2], 1ul);
+        REQUIRE(alloc.allocate(1ul) == &p[2]); // last freed is reused first
+        REQUIRE(alloc.allocate(1ul) == &p[1]); // then the rest of its chunk
+        REQUIRE(alloc.allocate(1ul) == &q[1]);
+    }
+
+    SECTION("elements freed in random order") {
+        auto kept = alloc.allocate(10ul);
+        vector<double*> ps(90);
+        for (auto& p : ps)
+            p = alloc.allocate(1ul);
+        shuffle(ps.begin(), ps.end(), mt19937(5));
+        for (auto p : ps)
+            alloc.deallocate(p, 1ul);
+        // released chunks take their elements out of free list, the spare one keeps them
+        REQUIRE_THAT(alloc.chunk_count(), Equals(2ul));
+        set<double*> reused;
+        for (int i = 0; i < 10; ++i)
+            reused.insert(alloc.allocate(1ul));
+        REQUIRE_THAT(reused.size(), Equals(10ul));
+        REQUIRE(none_of(reused.begin(), reused.end(), [kept] (double* p) { return p >= kept && p < &kept[10]; }));
+        REQUIRE_THAT(alloc.chunk_count(), Equals(2ul));
+    }
+}
+
+TEST_CASE("allocation near hint") {
+    allocator_arena<double, 10ul> alloc;
+    SECTION("free run following hint") {
+        auto p = alloc.allocate(6ul);
+        alloc.deallocate(&p[1], 1ul);
+        alloc.deallocate(&p[4], 2ul);
+        REQUIRE(alloc.allocate_near(1ul, &p[0]) == &p[1]); // freed element isn't left in free list
+        REQUIRE(alloc.allocate_near(2ul, &p[1]) == &p[4]);
+        REQUIRE(alloc.allocate_near(4ul, &p[5]) == &p[6]);
+        alloc.deallocate(&p[2], 2ul);
+        REQUIRE(alloc.allocate_near(2ul, &p[9]) == &p[2]); // wraps to the start of chunk
+    }
+
+    SECTION("full chunk of hint") {
+        auto p = alloc.allocate(10ul);
+        auto q = alloc.allocate(2ul);
+        REQUIRE(alloc.allocate_near(1ul, &p[3]) == &q[2]);
+        REQUIRE_THAT(alloc.chunk_count(), Equals(2ul));
+        REQUIRE(alloc.allocate_near(1ul, nullptr) == &q[3]);
+    }
+}
+
+TEST_CASE("reclamation") {
+    SECTION("empty chunks over spare are released") {
+        allocator_arena<int, 10ul, reclaim_keep_spare<1>> alloc;
+        auto p1 = alloc.allocate(10ul);
+        auto p2 = alloc.allocate(10ul);
+        auto p3 = alloc.allocate(10ul);
+        REQUIRE_THAT(alloc.chunk_count(), Equals(3ul));
+        alloc.deallocate(p1, 10ul);
+        REQUIRE_THAT(alloc.chunk_count(), Equals(3ul)); // one empty chunk is kept
+        alloc.deallocate(p3, 10ul);
+        REQUIRE_THAT(alloc.chunk_count(), Equals(2ul));
+        alloc.deallocate(p2, 10ul);
+        REQUIRE_THAT(alloc.chunk_count(), Equals(1ul));
+    }
+
+    SECTION("chunks are released above high-water mark") {
+        allocator_arena<double, 10ul, reclaim_high_water<2>> alloc;
+        double* ps[4];
+        for (auto& p : ps)
+            p = alloc.allocate(10ul);
+        auto p = alloc.allocate(1ul);
+        alloc.deallocate(p, 1ul); // released together with its free list element
+        REQUIRE_THAT(alloc.chunk_count(), Equals(4ul));
+        alloc.deallocate(ps[0], 10ul);
+        alloc.deallocate(ps[1], 10ul);
+        REQUIRE_THAT(alloc.chunk_count(), Equals(2ul));
+        alloc.deallocate(ps[2], 10ul);
+        REQUIRE_THAT(alloc.chunk_count(), Equals(2ul));
+        REQUIRE(alloc.allocate(1ul) == ps[2]);
+    }
+
+    SECTION("trim") {
+        allocator_arena<double, 10ul, reclaim_never> alloc;
+        double* ps[4];
+        for (auto& p : ps)
+            p = alloc.allocate(1ul);
+        alloc.allocate(10ul);
+        alloc.allocate(10ul);
+        auto p = alloc.allocate(10ul);
+        for (auto p : ps)
+            alloc.deallocate(p, 1ul); // first chunk is empty but its elements are in free list
+        alloc.deallocate(p, 10ul);
+        REQUIRE_THAT(alloc.chunk_count(), Equals(4ul));
+        alloc.trim(1ul);
+        REQUIRE_THAT(alloc.chunk_count(), Equals(3ul));
+        alloc.trim();
+        REQUIRE_THAT(alloc.chunk_count(), Equals(2ul));
+    }
+}
+
+TEST_CASE("chunk growth") {
+    SECTION("runtime chunk size") {
+        allocator_arena<int, 10ul> alloc(4ul);
+        auto p1 = alloc.allocate(3ul);
+        auto p2 = alloc.allocate(2ul);
+        REQUIRE(alloc.chunk_count() == 2ul);
+        REQUIRE_FALSE(&p1[3ul] == p2);
+    }
+
+    SECTION("geometric growth") {
+        allocator_arena<int, 4ul, reclaim_never, grow_geometric<2, 4>> alloc;
+        REQUIRE_THAT(alloc.max_chunk_size(), Equals(16ul));
+        alloc.allocate(4ul); // 4
+        alloc.allocate(8ul); // 8
+        auto p1 = alloc.allocate(10ul); // 16
+        auto p2 = alloc.allocate(6ul);
+        REQUIRE_THAT(alloc.chunk_count(), Equals(3ul));
+        REQUIRE(&p1[10ul] == p2);
+        alloc.allocate(16ul); // 16 at most
+        REQUIRE_THAT(alloc.chunk_count(), Equals(4ul));
+
+        alloc.deallocate(p2, 6ul);
+        alloc.deallocate(p1, 10ul);
+        REQUIRE(alloc.allocate(16ul) == p1);
+    }
+
+    SECTION("large blocks") {
+        allocator_arena<int, 10ul> alloc;
+        auto p1 = alloc.allocate(1000ul);
+        auto p2 = alloc.allocate(11ul);
+        REQUIRE_THAT(alloc.chunk_count(), Equals(0ul));
+        for (auto i = 0; i < 1000; ++i)
+            p1[i] = i;
+        alloc.deallocate(p1, 1000ul);
+        alloc.allocate(10ul);
+        REQUIRE_THAT(alloc.chunk_count(), Equals(1ul));
+        alloc.deallocate(p2, 11ul);
+    }
+}
+
+TEST_CASE("alignment") {
+    SECTION("chunk elements start on cache line") {
+        allocator_arena<char, 10ul> alloc;
+        REQUIRE(reinterpret_cast<uintptr_t>(alloc.allocate(10ul)) % 64ul == 0ul);
+    }
+
+    SECTION("over-aligned elements") {
+        struct alignas(256) wide { char bytes[256]; };
+        allocator_arena<wide, 4ul> alloc;
+        wide* ps[6];
+        for (auto& p : ps) {
+            p = alloc.allocate(1ul);
+            REQUIRE(reinterpret_cast<uintptr_t>(p) % alignof(wide) == 0ul);
+        }
+        auto large = alloc.allocate(5ul);
+        REQUIRE(reinterpret_cast<uintptr_t>(large) % alignof(wide) == 0ul);
+        alloc.deallocate(large, 5ul);
+        for (auto p : ps)
+            alloc.deallocate(p, 1ul);
+    }
+}
+
+TEST_CASE("ownership") {
+    SECTION("move takes chunks and large blocks") {
+        allocator_arena<int, 10ul> alloc(4ul);
+        auto p1 = alloc.allocate(3ul);
+        auto p2 = alloc.allocate(100ul);
+        alloc.deallocate(alloc.allocate(1ul), 1ul);
+
+        auto moved = std::move(alloc);
+        REQUIRE_THAT(moved.chunk_count(), Equals(1ul));
+        REQUIRE_THAT(alloc.chunk_count(), Equals(0ul));
+        REQUIRE(moved != alloc);
+
+        // moved-from arena keeps runtime chunk size
+        auto p3 = alloc.allocate(3ul);
+        alloc.allocate(2ul);
+        REQUIRE_THAT(alloc.chunk_count(), Equals(2ul));
+
+        swap(alloc, moved);
+        moved.deallocate(p3, 3ul);
+        alloc.deallocate(p2, 100ul);
+        alloc.deallocate(p1, 3ul);
+        REQUIRE(alloc == alloc);
+    }
 }
 
 TEST_CASE("construction") {
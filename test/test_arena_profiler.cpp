@@ -0,0 +1,122 @@
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <allocator.h>
+#include <arena_profiler.h>
+#include <bidirectional_list.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace griha;
+using namespace Catch::Matchers;
+
+namespace {
+
+using arena = allocator_arena<int, 64ul, reclaim_never, grow_fixed, malloc_source, arena_profiler>;
+
+} // namespace
+
+TEST_CASE("arena profiler") {
+    arena alloc;
+    auto& profiler = alloc.stats();
+
+    SECTION("sampling off") {
+        REQUIRE_THAT(profiler.sample_rate(), Equals(0ul));
+        vector<int*> ps;
+        for (int i = 0; i < 1000; ++i)
+            ps.push_back(alloc.allocate(4ul));
+        for (auto p : ps)
+            alloc.deallocate(p, 4ul);
+        REQUIRE(profiler.sites().empty());
+    }
+
+    SECTION("live and total per site") {
+        profiler.set_sample_rate(1); // every allocation is sampled
+        vector<int*> ps;
+        {
+            arena_profile_scope scope("fill");
+            for (int i = 0; i < 10; ++i)
+                ps.push_back(alloc.allocate(2ul));
+        }
+        int* large;
+        {
+            arena_profile_scope scope("large");
+            large = alloc.allocate(100ul);
+        }
+        for (int i = 0; i < 4; ++i)
+            alloc.deallocate(ps[i], 2ul);
+
+        auto& sites = profiler.sites();
+        REQUIRE_THAT(sites.size(), Equals(2ul));
+        REQUIRE_THAT(sites[0].tag, Equals("fill"));
+        REQUIRE_THAT(sites[0].total_samples, Equals(10ul));
+        REQUIRE_THAT(sites[0].live_samples, Equals(6ul));
+        REQUIRE_THAT(sites[0].live_sampled_bytes, Equals(6ul * 2 * sizeof(int)));
+        REQUIRE_THAT(sites[1].tag, Equals("large"));
+        REQUIRE_THAT(sites[1].live_samples, Equals(1ul));
+        REQUIRE_FALSE(sites[0].stack.empty());
+
+        alloc.deallocate(large, 100ul);
+        REQUIRE_THAT(sites[1].live_samples, Equals(0ul));
+        REQUIRE_THAT(sites[1].total_samples, Equals(1ul));
+        REQUIRE_THAT(profiler.live_samples(), Equals(6ul));
+    }
+
+    SECTION("deallocation of runs") {
+        profiler.set_sample_rate(1);
+        auto p1 = alloc.allocate(1ul);
+        auto p2 = alloc.allocate(1ul);
+        auto p3 = alloc.allocate(1ul);
+        REQUIRE(p2 == p1 + 1);
+        REQUIRE(p3 == p2 + 1);
+        REQUIRE_THAT(profiler.live_samples(), Equals(3ul));
+
+        // adjacent elements freed at once as by bidirectional_list
+        alloc.deallocate(p1, 3ul);
+        REQUIRE_THAT(profiler.live_samples(), Equals(0ul));
+    }
+
+    SECTION("estimates") {
+        profiler.set_sample_rate(4096);
+        vector<int*> ps;
+        for (int i = 0; i < 100000; ++i)
+            ps.push_back(alloc.allocate(16ul));
+        for (size_t i = 0; i < ps.size(); i += 2)
+            alloc.deallocate(ps[i], 16ul);
+
+        double live = 0., total = 0.;
+        for (auto& s : profiler.sites()) {
+            live += s.live_bytes;
+            total += s.total_bytes;
+        }
+        auto expected_total = 100000. * 16 * sizeof(int);
+        REQUIRE(total > expected_total * 0.9);
+        REQUIRE(total < expected_total * 1.1);
+        REQUIRE(live > expected_total / 2 * 0.85);
+        REQUIRE(live < expected_total / 2 * 1.15);
+    }
+
+    SECTION("dumps") {
+        profiler.set_sample_rate(1);
+        arena_profile_scope scope("dump");
+        auto p = alloc.allocate(8ul);
+
+        ostringstream pprof;
+        profiler.dump_pprof(pprof);
+        auto s = pprof.str();
+        REQUIRE_THAT(s, StartsWith("heap profile:      1:       32 [     1:       32] @ heap_v2/1\n"));
+        REQUIRE_THAT(s, Contains("\nMAPPED_LIBRARIES:\n"));
+
+        ostringstream text;
+        profiler.dump_text(text);
+        REQUIRE_THAT(text.str(), Contains("tag dump"));
+
+        alloc.deallocate(p, 8ul);
+        profiler.reset();
+        REQUIRE(profiler.sites().empty());
+    }
+}
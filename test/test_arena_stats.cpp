@@ -0,0 +1,80 @@
+#include <catch2/catch.hpp>
+
+#include <allocator.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace griha;
+using namespace Catch::Matchers;
+
+TEST_CASE("arena statistics") {
+    using arena = allocator_arena<int, 10ul, reclaim_never, grow_geometric<2, 4>, malloc_source, arena_stats<>>;
+    arena alloc;
+
+    SECTION("counters") {
+        auto p1 = alloc.allocate(6ul);
+        auto p2 = alloc.allocate(4ul);
+        auto p3 = alloc.allocate(50ul); // above maximal chunk capacity
+        alloc.deallocate(p2, 4ul);
+
+        auto s = alloc.stats_snapshot();
+        REQUIRE_THAT(s.allocations, Equals(3ul));
+        REQUIRE_THAT(s.large_allocations, Equals(1ul));
+        REQUIRE_THAT(s.deallocations, Equals(1ul));
+        REQUIRE_THAT(s.live_bytes, Equals(56ul * sizeof(int)));
+        REQUIRE_THAT(s.peak_live_bytes, Equals(60ul * sizeof(int)));
+        REQUIRE_THAT(s.chunk_lookups, Equals(1ul)); // owning chunk is found by address at once
+        REQUIRE_THAT(s.chunks, Equals(1ul));
+
+        alloc.deallocate(p1, 6ul);
+        alloc.deallocate(p3, 50ul);
+        s = alloc.stats_snapshot();
+        REQUIRE_THAT(s.live_bytes, Equals(0ul));
+        REQUIRE_THAT(s.chunk_lookups, Equals(2ul)); // large blocks do not have chunks
+
+        uint64_t timed = 0;
+        for (auto v : s.allocate_latency)
+            timed += v;
+        REQUIRE_THAT(timed, Equals(s.allocations));
+    }
+
+    SECTION("search cost") {
+        alloc.allocate(10ul); // fills the first chunk
+        alloc.allocate(3ul);  // creates the second one
+        auto s = alloc.stats_snapshot();
+        REQUIRE_THAT(s.chunks_walked, Equals(0ul)); // full chunk is not visited at all
+        REQUIRE_THAT(s.bits_scanned, Equals(0ul));
+
+        alloc.allocate(2ul);
+        s = alloc.stats_snapshot();
+        REQUIRE_THAT(s.chunks_walked, Equals(1ul));
+        REQUIRE_THAT(s.bits_scanned, Equals(5ul));
+    }
+
+    SECTION("fragmentation") {
+        int* p[10];
+        for (auto& v : p)
+            v = alloc.allocate(1ul);
+        for (auto i = 0ul; i < 10ul; i += 2)
+            alloc.deallocate(p[i], 1ul);
+        alloc.allocate(2ul); // flushes freed elements into chunk state
+
+        auto s = alloc.stats_snapshot();
+        REQUIRE_THAT(s.chunks, Equals(2ul));
+        REQUIRE_THAT(s.free_slots, Equals(5ul + 18ul));
+        REQUIRE_THAT(s.largest_free_run, Equals(18ul));
+        REQUIRE(s.fragmentation() > 0.2);
+        REQUIRE(s.fragmentation() < 0.3);
+    }
+}
+
+TEST_CASE("arena without statistics") {
+    allocator_arena<int, 10ul> alloc;
+    alloc.deallocate(alloc.allocate(4ul), 4ul);
+    auto s = alloc.stats_snapshot();
+    REQUIRE_THAT(s.allocations, Equals(0ul)); // no_stats collects nothing
+    REQUIRE_THAT(s.chunks, Equals(1ul));
+    REQUIRE_THAT(s.free_slots, Equals(10ul));
+    REQUIRE_THAT(s.largest_free_run, Equals(10ul));
+}
@@ -1,9 +1,19 @@
 #include <catch2/catch.hpp>
 
+#include <algorithm>
 #include <array>
+#include <memory>
 #include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
+#include <allocator.h>
 #include <bidirectional_list.h>
+#include <monotonic_allocator.h>
+#include <shared_arena.h>
 
 #include "utils.h"
 
@@ -22,7 +32,8 @@ TEST_CASE("bidirectional_list") {
 
     SECTION("emplace") {
         bidirectional_list<pair<int, float>> blist;
-        REQUIRE(blist.emplace(blist.end(), 1, 1.) == blist.begin());
+        auto it = blist.emplace(blist.end(), 1, 1.);
+        REQUIRE(it == blist.begin());
         REQUIRE_FALSE(blist.empty());
         REQUIRE_THAT(blist.size(), Equals(1ul));
 
@@ -32,10 +43,11 @@ TEST_CASE("bidirectional_list") {
         blist.emplace(blist.end(), 2, 2.);
         REQUIRE_THAT(blist.size(), Equals(2ul));
 
-        REQUIRE(blist.emplace(blist.begin(), 3, 3.) == blist.begin());
+        it = blist.emplace(blist.begin(), 3, 3.);
+        REQUIRE(it == blist.begin());
         REQUIRE_THAT(blist.size(), Equals(3ul));
 
-        auto it = blist.begin();
+        it = blist.begin();
         ++it;
         blist.emplace(it, 4, 4.);
         REQUIRE_THAT(blist.size(), Equals(4ul));
@@ -173,4 +185,570 @@ TEST_CASE("bidirectional_list") {
         REQUIRE_THAT(blist.size(), Equals(1ul));
         REQUIRE_THAT(*blist.begin(), Equals(100));
     }
-}
\ No newline at end of file
+}
+namespace {
+
+template <typename T, typename Alloc>
+bool links_consistent(const bidirectional_list<T, Alloc>& l) {
+    vector<T> backward;
+    auto it = l.cend();
+    for (size_t i = 0; i < l.size(); ++i) {
+        --it;
+        backward.push_back(*it);
+    }
+    auto forward = values_of(l);
+    return it == l.cbegin() && equal(forward.rbegin(), forward.rend(), backward.begin(), backward.end());
+}
+
+size_t allocations_n = 0;
+
+template <typename T>
+struct counting_allocator : allocator<T> {
+    template <typename U>
+    struct rebind { using other = counting_allocator<U>; };
+
+    counting_allocator() = default;
+    template <typename U>
+    counting_allocator(const counting_allocator<U>&) {}
+
+    T* allocate(size_t n) {
+        ++allocations_n;
+        return allocator<T>::allocate(n);
+    }
+};
+
+// takes back sequences piecewise and records sizes of requests
+vector<size_t> allocated_n, deallocated_n;
+
+template <typename T>
+struct recording_allocator : monotonic_allocator<T> {
+    template <typename U>
+    struct rebind { using other = recording_allocator<U>; };
+
+    recording_allocator(monotonic_arena<>& arena) : monotonic_allocator<T>(arena) {}
+    template <typename U>
+    recording_allocator(const recording_allocator<U>& other) : monotonic_allocator<T>(other.arena()) {}
+
+    T* allocate(size_t n) {
+        allocated_n.push_back(n);
+        return monotonic_allocator<T>::allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        deallocated_n.push_back(n);
+        monotonic_allocator<T>::deallocate(p, n);
+    }
+
+    size_t max_piecewise_size() const { return 8; }
+};
+
+// stateful allocator which doesn't propagate on move assignment
+template <typename T>
+struct tagged_allocator : allocator<T> {
+    template <typename U>
+    struct rebind { using other = tagged_allocator<U>; };
+
+    using propagate_on_container_move_assignment = false_type;
+    using is_always_equal = false_type;
+
+    explicit tagged_allocator(int tag) : tag(tag) {}
+    template <typename U>
+    tagged_allocator(const tagged_allocator<U>& other) : tag(other.tag) {}
+
+    friend bool operator== (const tagged_allocator& lhs, const tagged_allocator& rhs) { return lhs.tag == rhs.tag; }
+    friend bool operator!= (const tagged_allocator& lhs, const tagged_allocator& rhs) { return lhs.tag != rhs.tag; }
+
+    int tag;
+};
+
+template <typename T = int>
+bidirectional_list<T> make_list(initializer_list<T> values) {
+    bidirectional_list<T> ret;
+    for (auto& v : values)
+        ret.emplace(ret.end(), v);
+    return ret;
+}
+
+} // namespace
+
+TEST_CASE("bidirectional_list operations") {
+    SECTION("splice") {
+        auto a = make_list({1, 2, 3});
+        auto b = make_list({4, 5, 6, 7});
+
+        auto pos = a.begin();
+        ++pos;
+        a.splice(pos, b, b.begin()); // single element
+        REQUIRE(values_of(a) == vector<int>({1, 4, 2, 3}));
+        REQUIRE(values_of(b) == vector<int>({5, 6, 7}));
+
+        auto last = b.begin();
+        ++last;
+        ++last;
+        a.splice(a.end(), b, b.begin(), last); // range
+        REQUIRE(values_of(a) == vector<int>({1, 4, 2, 3, 5, 6}));
+        REQUIRE_THAT(a.size(), Equals(6ul));
+        REQUIRE_THAT(b.size(), Equals(1ul));
+
+        a.splice(a.begin(), b); // whole list
+        REQUIRE(values_of(a) == vector<int>({7, 1, 4, 2, 3, 5, 6}));
+        REQUIRE(b.empty());
+        REQUIRE(b.begin() == b.end());
+
+        auto first = a.begin();
+        ++first;
+        last = first;
+        ++last;
+        ++last;
+        a.splice(a.end(), a, first, last); // within the same list
+        REQUIRE(values_of(a) == vector<int>({7, 2, 3, 5, 6, 1, 4}));
+        REQUIRE_THAT(a.size(), Equals(7ul));
+        REQUIRE(links_consistent(a));
+    }
+
+    SECTION("merge") {
+        auto a = make_list({1, 3, 5, 5, 9});
+        auto b = make_list({0, 2, 5, 10, 11});
+        a.merge(b);
+        REQUIRE(values_of(a) == vector<int>({0, 1, 2, 3, 5, 5, 5, 9, 10, 11}));
+        REQUIRE_THAT(a.size(), Equals(10ul));
+        REQUIRE(b.empty());
+        REQUIRE(links_consistent(a));
+
+        a = make_list({1, 3, 5, 7});
+        b = make_list({0, 2, 4, 6});
+        int calls = 0;
+        auto throwing = [&calls] (int lhs, int rhs) {
+            if (++calls == 4)
+                throw runtime_error("comparison");
+            return lhs < rhs;
+        };
+        REQUIRE_THROWS_AS(a.merge(b, throwing), runtime_error);
+        REQUIRE(values_of(a) == vector<int>({0, 1, 2, 3, 5, 7})); // moved elements belong to this list only
+        REQUIRE(values_of(b) == vector<int>({4, 6}));
+        REQUIRE_THAT(a.size(), Equals(6ul));
+        REQUIRE_THAT(b.size(), Equals(2ul));
+        REQUIRE(links_consistent(a));
+        REQUIRE(links_consistent(b));
+    }
+
+    SECTION("stable sort") {
+        bidirectional_list<pair<int, int>> l;
+        mt19937 gen(3);
+        for (int i = 0; i < 1000; ++i)
+            l.emplace(l.end(), int(gen() % 50), i);
+        auto ref = values_of(l);
+
+        auto by_key = [] (auto& lhs, auto& rhs) { return lhs.first < rhs.first; };
+        l.sort(by_key);
+        stable_sort(ref.begin(), ref.end(), by_key);
+        REQUIRE(values_of(l) == ref);
+        REQUIRE(links_consistent(l));
+    }
+
+    SECTION("sort with throwing comparison") {
+        bidirectional_list<int> l;
+        for (int i = 0; i < 16; ++i)
+            l.emplace(l.end(), 15 - i);
+
+        int calls = 0;
+        auto throwing = [&calls] (int lhs, int rhs) {
+            if (++calls == 20)
+                throw runtime_error("comparison");
+            return lhs < rhs;
+        };
+        REQUIRE_THROWS_AS(l.sort(throwing), runtime_error);
+        REQUIRE_THAT(l.size(), Equals(16ul));
+        REQUIRE(links_consistent(l));
+        auto values = values_of(l);
+        sort(values.begin(), values.end());
+        vector<int> ref(16);
+        iota(ref.begin(), ref.end(), 0);
+        REQUIRE(values == ref); // all elements are kept
+
+        l.sort();
+        REQUIRE(values_of(l) == ref);
+    }
+
+    SECTION("reverse, unique and remove_if") {
+        auto l = make_list({1, 1, 2, 3, 3, 3, 4, 1});
+        REQUIRE_THAT(l.unique(), Equals(3ul));
+        REQUIRE(values_of(l) == vector<int>({1, 2, 3, 4, 1}));
+
+        l.reverse();
+        REQUIRE(values_of(l) == vector<int>({1, 4, 3, 2, 1}));
+        REQUIRE(links_consistent(l));
+
+        REQUIRE_THAT(l.remove(1), Equals(2ul));
+        REQUIRE_THAT(l.remove_if([] (int v) { return v % 2 == 0; }), Equals(2ul));
+        REQUIRE(values_of(l) == vector<int>({3}));
+        REQUIRE(links_consistent(l));
+    }
+
+    SECTION("no allocations") {
+        bidirectional_list<int, counting_allocator<int>> l;
+        mt19937 gen(5);
+        for (int i = 0; i < 100; ++i)
+            l.emplace(l.end(), int(gen() % 100));
+        auto allocations = allocations_n;
+
+        l.sort();
+        l.reverse();
+        l.unique();
+        bidirectional_list<int, counting_allocator<int>> other;
+        other.emplace(other.end(), 50);
+        l.merge(other, greater<>());
+        auto last = l.end();
+        --last;
+        l.splice(l.begin(), l, last);
+        REQUIRE_THAT(allocations_n, Equals(allocations + 1)); // the only node of other list
+    }
+}
+
+TEST_CASE("bidirectional_list range insertion") {
+    vector<int> values(100);
+    iota(values.begin(), values.end(), 0);
+
+    SECTION("insert and assign") {
+        bidirectional_list<int, allocator_arena<int, 16>> l;
+        l.insert(l.end(), {1000, 1001});
+        auto pos = l.begin();
+        ++pos;
+        auto it = l.insert(pos, values.begin(), values.end());
+        REQUIRE_THAT(*it, Equals(0));
+        REQUIRE_THAT(l.size(), Equals(102ul));
+        REQUIRE(links_consistent(l));
+
+        auto ref = values;
+        ref.insert(ref.begin(), 1000);
+        ref.push_back(1001);
+        REQUIRE(values_of(l) == ref);
+
+        REQUIRE(l.insert(l.begin(), values.begin(), values.begin()) == l.begin());
+
+        // size of input range is unknown, unused nodes of the last batch are returned
+        istringstream in("5 6 7");
+        l.assign(istream_iterator<int>(in), istream_iterator<int>());
+        REQUIRE(values_of(l) == vector<int>({5, 6, 7}));
+        REQUIRE_THAT(l.size(), Equals(3ul));
+        REQUIRE(links_consistent(l));
+
+        l.clear();
+        REQUIRE(l.empty());
+        REQUIRE_THAT(l.size(), Equals(0ul));
+    }
+
+    SECTION("nodes by one") {
+        bidirectional_list<int, counting_allocator<int>> l;
+        auto allocations = allocations_n;
+        l.insert(l.end(), values.begin(), values.end());
+        REQUIRE_THAT(allocations_n, Equals(allocations + values.size()));
+
+        auto copy = l;
+        REQUIRE_THAT(allocations_n, Equals(allocations + 2 * values.size()));
+        REQUIRE_THAT(copy.size(), Equals(values.size()));
+        REQUIRE(values_of(copy) == values);
+        REQUIRE(links_consistent(copy));
+    }
+
+    SECTION("nodes by batches") {
+        monotonic_arena<> arena(1ul << 12);
+        allocated_n.clear();
+        deallocated_n.clear();
+        {
+            bidirectional_list<int, recording_allocator<int>> l(arena);
+            l.insert(l.end(), values.begin(), values.begin() + 20);
+            REQUIRE(allocated_n == vector<size_t>({8, 8, 4}));
+
+            istringstream in("1 2 3");
+            l.insert(l.end(), istream_iterator<int>(in), istream_iterator<int>());
+            REQUIRE(allocated_n == vector<size_t>({8, 8, 4, 8}));
+            REQUIRE(deallocated_n == vector<size_t>({5}));
+            deallocated_n.clear();
+
+            // erased node splits the first run
+            auto second = l.begin();
+            ++second;
+            l.erase(second);
+            REQUIRE(deallocated_n == vector<size_t>({1}));
+            deallocated_n.clear();
+        }
+        // arena places batches one after another, so runs of adjacent nodes span them
+        REQUIRE(deallocated_n == vector<size_t>({1, 8, 8, 5}));
+    }
+
+    SECTION("uninitialized append") {
+        monotonic_arena<> arena(1ul << 16);
+        allocated_n.clear();
+        deallocated_n.clear();
+        bidirectional_list<int, recording_allocator<int>> l(arena);
+        l.push_back(-1);
+
+        int next = 0;
+        size_t calls = 0;
+        auto fill = [&] (int* const* values, size_t n) {
+            if (++calls == 2)
+                throw runtime_error("fill");
+            for (size_t i = 0; i < n; ++i)
+                *values[i] = next++;
+        };
+        auto group = decltype(l)::fill_group;
+        REQUIRE_THROWS_AS(l.append_uninitialized(group + 20, fill), runtime_error);
+
+        // the first group is appended, nodes of the failed one are freed
+        REQUIRE_THAT(l.size(), Equals(group + 1));
+        REQUIRE(links_consistent(l));
+        REQUIRE_THAT(l.back(), Equals(int(group) - 1));
+        auto live = accumulate(allocated_n.begin(), allocated_n.end(), size_t(0)) -
+                    accumulate(deallocated_n.begin(), deallocated_n.end(), size_t(0));
+        REQUIRE_THAT(live, Equals(l.size()));
+
+        l.append_uninitialized(3, fill);
+        REQUIRE_THAT(l.size(), Equals(group + 4));
+        REQUIRE_THAT(l.back(), Equals(int(group) + 2));
+    }
+}
+
+TEST_CASE("bidirectional_list insertion api") {
+    SECTION("forwarding") {
+        bidirectional_list<unique_ptr<int>> l;
+        l.emplace_back(new int(2));
+        l.push_back(make_unique<int>(3));
+        l.push_front(make_unique<int>(1));
+        auto& v = l.emplace_front(new int(0));
+        REQUIRE(&v == &l.front());
+        REQUIRE_THAT(l.size(), Equals(4ul));
+
+        vector<int> values;
+        for (auto& p : l)
+            values.push_back(*p);
+        REQUIRE(values == vector<int>({0, 1, 2, 3}));
+
+        auto it = l.end();
+        --it;
+        auto p = it->get();
+        REQUIRE(p == l.back().get());
+
+        l.pop_back();
+        l.pop_front();
+        REQUIRE_THAT(*l.front(), Equals(1));
+        REQUIRE_THAT(*l.back(), Equals(2));
+        REQUIRE_THAT(l.size(), Equals(2ul));
+        l.pop_back();
+        l.pop_back();
+        REQUIRE(l.empty());
+    }
+
+    SECTION("no copies") {
+        struct tracked {
+            explicit tracked(int* copies) : copies(copies) {}
+            tracked(const tracked& src) : copies(src.copies) { ++*copies; }
+            tracked(tracked&&) = default;
+            int* copies;
+        };
+
+        int copies = 0;
+        bidirectional_list<tracked> l;
+        tracked t(&copies);
+        l.emplace(l.end(), std::move(t));
+        l.push_back(tracked(&copies));
+        l.emplace_back(&copies);
+        REQUIRE_THAT(copies, Equals(0));
+        l.push_back(t);
+        REQUIRE_THAT(copies, Equals(1));
+    }
+
+    SECTION("assignment reuses nodes") {
+        bidirectional_list<string, counting_allocator<string>> l;
+        for (int i = 0; i < 10; ++i)
+            l.push_back(string(64, char('a' + i)));
+        auto front = &l.front();
+        auto allocations = allocations_n;
+
+        vector<string> shorter(4, "x");
+        l.assign(shorter.begin(), shorter.end());
+        REQUIRE_THAT(allocations_n, Equals(allocations));
+        REQUIRE(&l.front() == front);
+        REQUIRE(values_of(l) == shorter);
+        REQUIRE(links_consistent(l));
+
+        l.assign(6, "y");
+        REQUIRE_THAT(allocations_n, Equals(allocations + 2));
+        REQUIRE(values_of(l) == vector<string>(6, "y"));
+        REQUIRE_THAT(l.size(), Equals(6ul));
+
+        bidirectional_list<string, counting_allocator<string>> other;
+        other.push_back("z");
+        other.push_back("w");
+        allocations = allocations_n;
+        l = other;
+        REQUIRE_THAT(allocations_n, Equals(allocations));
+        REQUIRE(&l.front() == front);
+        REQUIRE(values_of(l) == vector<string>({"z", "w"}));
+        REQUIRE(links_consistent(l));
+
+        l = l;
+        REQUIRE(values_of(l) == vector<string>({"z", "w"}));
+
+        l.assign({"a", "b", "c"});
+        REQUIRE_THAT(allocations_n, Equals(allocations + 1));
+        REQUIRE(values_of(l) == vector<string>({"a", "b", "c"}));
+    }
+}
+
+TEST_CASE("bidirectional_list allocators") {
+    SECTION("shared arena") {
+        shared_arena_allocator<int, 64> alloc;
+        bidirectional_list<int, shared_arena_allocator<int, 64>> a(alloc), b(alloc);
+        a.assign({1, 2, 3});
+        b.assign({4, 5});
+        auto front = &a.front();
+
+        a.swap(b);
+        REQUIRE(&b.front() == front);
+        b.splice(b.end(), a);
+        REQUIRE(values_of(b) == vector<int>({1, 2, 3, 4, 5}));
+
+        a = std::move(b);
+        REQUIRE(&a.front() == front);
+        REQUIRE(b.empty());
+
+        auto c = a;
+        REQUIRE(c.get_allocator() == alloc);
+        REQUIRE(values_of(c) == values_of(a));
+    }
+
+    SECTION("arena owned by list") {
+        bidirectional_list<int, allocator_arena<int, 16>> a;
+        a.assign({1, 2, 3});
+        auto front = &a.front();
+
+        auto b = std::move(a);
+        REQUIRE(&b.front() == front);
+        REQUIRE(a.empty());
+        a.push_back(7);
+
+        swap(a, b);
+        REQUIRE(&a.front() == front);
+        REQUIRE(values_of(b) == vector<int>({7}));
+
+        b = std::move(a);
+        REQUIRE(&b.front() == front);
+        REQUIRE(links_consistent(b));
+
+        // copy gets its own arena
+        auto c = b;
+        REQUIRE(values_of(c) == vector<int>({1, 2, 3}));
+        b.clear();
+        REQUIRE(values_of(c) == vector<int>({1, 2, 3}));
+    }
+
+    SECTION("non-propagating allocator") {
+        bidirectional_list<string, tagged_allocator<string>> a(tagged_allocator<string>(1));
+        bidirectional_list<string, tagged_allocator<string>> b(tagged_allocator<string>(2));
+        bidirectional_list<string, tagged_allocator<string>> c(tagged_allocator<string>(1));
+        a.push_back("x");
+        auto front = &a.front();
+
+        // unequal allocators, elements are moved into new nodes
+        b = std::move(a);
+        REQUIRE(a.empty());
+        REQUIRE(&b.front() != front);
+        REQUIRE(values_of(b) == vector<string>({"x"}));
+        REQUIRE(b.get_allocator().tag == 2);
+
+        front = &b.front();
+        a.push_back("y");
+        c = std::move(a);
+        REQUIRE(values_of(c) == vector<string>({"y"}));
+        REQUIRE(c.get_allocator().tag == 1);
+        b = std::move(c);
+        REQUIRE(values_of(b) == vector<string>({"y"}));
+        REQUIRE(&b.front() == front); // node of b is reused
+    }
+}
+
+namespace {
+
+// number of elements placed in memory right after their predecessors
+template <typename T, typename Alloc>
+size_t sequential_pairs(const bidirectional_list<T, Alloc>& l) {
+    size_t ret = 0;
+    for (auto it = l.begin(), next = it; it != l.end() && ++next != l.end(); ++it) {
+        auto d = reinterpret_cast<const char*>(&*next) - reinterpret_cast<const char*>(&*it);
+        ret += d > 0 && d <= ptrdiff_t(sizeof(T) + 2 * sizeof(void*) + alignof(void*));
+    }
+    return ret;
+}
+
+} // namespace
+
+TEST_CASE("bidirectional_list locality") {
+    SECTION("hinted insertion") {
+        bidirectional_list<int, allocator_arena<int, 8>> l;
+        for (int i = 0; i < 16; ++i)
+            l.push_back(i);
+        REQUIRE_THAT(sequential_pairs(l), Equals(14ul)); // the only break is between chunks
+
+        auto node2 = &*next(l.begin(), 2);
+        auto node12 = &*next(l.begin(), 12);
+        l.erase(next(l.begin(), 2));
+        l.erase(next(l.begin(), 11));
+
+        // freed node of predecessor's chunk is taken rather than the last freed one
+        l.insert(next(l.begin(), 2), 2);
+        REQUIRE(&*next(l.begin(), 2) == node2);
+        REQUIRE_THAT(sequential_pairs(l), Equals(12ul));
+        l.push_back(16);
+        REQUIRE(&l.back() == node12);
+        REQUIRE(values_of(l) == vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 14, 15, 16}));
+    }
+
+    SECTION("incremental defragmentation") {
+        bidirectional_list<int, allocator_arena<int, 64>> l;
+        for (int i = 0; i < 1000; ++i)
+            l.push_back(i);
+        mt19937 gen(1);
+        vector<int> keys(1000);
+        iota(keys.begin(), keys.end(), 0);
+        shuffle(keys.begin(), keys.end(), gen);
+        l.sort([&keys] (int a, int b) { return keys[a] < keys[b]; });
+        auto values = values_of(l);
+        REQUIRE(sequential_pairs(l) < 50);
+
+        size_t calls = 1;
+        for (; !l.defragment(100); ++calls);
+        REQUIRE_THAT(calls, Equals(10ul));
+        REQUIRE(values_of(l) == values);
+        REQUIRE(links_consistent(l));
+        REQUIRE_THAT(l.size(), Equals(1000ul));
+        REQUIRE(sequential_pairs(l) > 999 - 2 * 1000 / 64); // runs are broken at chunks and calls
+
+        // ordered list is only visited
+        auto front = &l.front();
+        REQUIRE(l.defragment(1000));
+        REQUIRE(&l.front() == front);
+    }
+
+    SECTION("list changed between steps") {
+        bidirectional_list<int, shared_arena_allocator<int, 64>> l;
+        for (int i = 0; i < 200; ++i)
+            l.push_back(i);
+        l.sort([] (int a, int b) { return a * 7919 % 200 < b * 7919 % 200; });
+        auto expected = values_of(l);
+        REQUIRE_FALSE(l.defragment(30));
+
+        // erase of the last visited node and splice out of the list move position of the pass
+        l.remove_if([] (int v) { return v % 3 == 0; });
+        expected.erase(remove_if(expected.begin(), expected.end(), [] (int v) { return v % 3 == 0; }),
+                       expected.end());
+        bidirectional_list<int, shared_arena_allocator<int, 64>> other(l.get_allocator());
+        other.splice(other.end(), l, l.begin(), next(l.begin(), 10));
+        for (; !l.defragment(7););
+
+        REQUIRE(values_of(other) == vector<int>(expected.begin(), expected.begin() + 10));
+        REQUIRE(values_of(l) == vector<int>(expected.begin() + 10, expected.end()));
+        REQUIRE(links_consistent(l));
+        REQUIRE(sequential_pairs(l) > l.size() - 10);
+    }
+}
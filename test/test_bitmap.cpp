@@ -0,0 +1,72 @@
+#include <catch2/catch.hpp>
+
+#include <bitmap.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace griha;
+using namespace Catch::Matchers;
+
+TEST_CASE("bitmap") {
+    SECTION("set and reset across words") {
+        bitmap<200> bm;
+        REQUIRE(bm.none());
+        bm.set(60, 140);
+        REQUIRE_THAT(bm.count(), Equals(80ul));
+        REQUIRE_FALSE(bm.test(59));
+        REQUIRE(bm.test(60));
+        REQUIRE(bm.test(139));
+        REQUIRE_FALSE(bm.test(140));
+
+        bm.reset(64, 128);
+        REQUIRE_THAT(bm.count(), Equals(16ul));
+        REQUIRE_THAT(bm.find_one(), Equals(60ul));
+        REQUIRE_THAT(bm.find_one(64), Equals(128ul));
+    }
+
+    SECTION("find zero") {
+        bitmap<130> bm;
+        bm.set(0, 130);
+        REQUIRE(bm.all());
+        REQUIRE_THAT(bm.find_zero(), Equals(bm.npos));
+        bm.reset(129, 130);
+        REQUIRE_THAT(bm.find_zero(), Equals(129ul));
+    }
+
+    SECTION("find zero run") {
+        bitmap<300> bm;
+        bm.set(0, 10);
+        bm.set(12, 70);
+        bm.set(200, 300);
+        REQUIRE_THAT(bm.find_zero_run(1), Equals(10ul));
+        REQUIRE_THAT(bm.find_zero_run(2), Equals(10ul));
+        REQUIRE_THAT(bm.find_zero_run(3), Equals(70ul));
+        REQUIRE_THAT(bm.find_zero_run(130), Equals(70ul));
+        REQUIRE_THAT(bm.find_zero_run(131), Equals(bm.npos));
+        REQUIRE_THAT(bm.find_zero_run(1, 71), Equals(71ul));
+    }
+
+    SECTION("largest zero run") {
+        bitmap<300> bm;
+        REQUIRE_THAT(bm.largest_zero_run(), Equals(300ul));
+        bm.set(0, 10);
+        bm.set(12, 70);
+        bm.set(200, 300);
+        REQUIRE_THAT(bm.largest_zero_run(), Equals(130ul));
+        bm.set(0, 300);
+        REQUIRE_THAT(bm.largest_zero_run(), Equals(0ul));
+    }
+
+    SECTION("find best zero run") {
+        bitmap<300> bm;
+        bm.set(0, 10);
+        bm.set(12, 70);
+        bm.set(75, 200);
+        bm.set(204, 300);
+        REQUIRE_THAT(bm.find_best_zero_run(1), Equals(10ul));
+        REQUIRE_THAT(bm.find_best_zero_run(3), Equals(200ul));
+        REQUIRE_THAT(bm.find_best_zero_run(5), Equals(70ul));
+        REQUIRE_THAT(bm.find_best_zero_run(6), Equals(bm.npos));
+    }
+}
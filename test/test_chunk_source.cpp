@@ -0,0 +1,115 @@
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+
+#include <allocator.h>
+#include <chunk_source.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace griha;
+using namespace Catch::Matchers;
+
+namespace {
+
+template <typename Source>
+void check_source(Source& source, size_t alignment) {
+    auto p1 = static_cast<char*>(source.allocate(3 * alignment, alignment));
+    auto p2 = static_cast<char*>(source.allocate(100ul, alignment));
+    REQUIRE(reinterpret_cast<uintptr_t>(p1) % alignment == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(p2) % alignment == 0);
+    p1[0] = p1[3 * alignment - 1] = 'a'; // memory is writable
+    p2[0] = p2[99] = 'b';
+    REQUIRE(p1[0] == 'a');
+    REQUIRE(p2[99] == 'b');
+    source.deallocate(p1, 3 * alignment);
+    source.deallocate(p2, 100ul);
+}
+
+template <typename Source>
+void check_arena() {
+    allocator_arena<double, 1000ul, reclaim_never, grow_geometric<>, Source> alloc;
+    auto p1 = alloc.allocate(1000ul);
+    auto p2 = alloc.allocate(100000ul); // large block
+    for (auto i = 0; i < 1000; ++i)
+        p1[i] = i;
+    for (auto i = 0; i < 100000; ++i)
+        p2[i] = i;
+    alloc.deallocate(p1, 1000ul);
+    REQUIRE(alloc.allocate(1ul) == p1);
+    alloc.deallocate(p2, 100000ul);
+}
+
+}
+
+TEST_CASE("chunk sources") {
+    SECTION("malloc") {
+        malloc_source source;
+        check_source(source, 64ul);
+        check_source(source, 1ul << 16);
+        check_arena<malloc_source>();
+    }
+
+    SECTION("mmap") {
+        mmap_source<> source;
+        check_source(source, 64ul);
+        check_source(source, 1ul << 16);
+        check_arena<mmap_source<>>();
+    }
+
+    SECTION("mmap with huge pages") {
+        mmap_source<huge_pages::transparent> source;
+        check_source(source, 1ul << 16);
+        mmap_source<huge_pages::hugetlb> source_hugetlb;
+        check_source(source_hugetlb, 1ul << 16);
+        check_arena<mmap_source<huge_pages::hugetlb>>();
+    }
+
+    SECTION("reserved range") {
+        reserved_source<(1ul << 20)> source;
+        auto p1 = source.allocate(1ul << 19, 1ul << 16);
+        check_source(source, 64ul);
+        check_source(source, 1ul << 16);
+        source.deallocate(p1, 1ul << 19);
+        REQUIRE(source.allocate(1ul << 19, 1ul << 16) == p1); // range is reused
+        source.allocate(1ul << 20, 1ul << 16); // another range is reserved
+        check_arena<reserved_source<>>();
+    }
+
+    SECTION("reserved range is not fragmented") {
+        reserved_source<(1ul << 20)> source;
+        char* ps[16];
+        for (auto& p : ps)
+            p = static_cast<char*>(source.allocate(1ul << 16, 1ul << 16));
+        for (size_t i = 0; i < 16; i += 2)
+            source.deallocate(ps[i], 1ul << 16);
+        for (size_t i = 1; i < 16; i += 2)
+            source.deallocate(ps[i], 1ul << 16);
+        REQUIRE(source.allocate(1ul << 20, 1ul << 16) == ps[0]); // freed ranges are merged
+        source.deallocate(ps[0], 1ul << 20);
+
+        // padding skipped for alignment is reused
+        auto p1 = static_cast<char*>(source.allocate(4096ul, 4096ul));
+        auto p2 = static_cast<char*>(source.allocate(1ul << 16, 1ul << 16));
+        REQUIRE(source.allocate(4096ul, 4096ul) == p1 + 4096);
+        REQUIRE(p2 == ps[1]);
+    }
+
+    SECTION("arena over reserved range is moved and swapped") {
+        using arena = allocator_arena<double, 1000ul, reclaim_never, grow_fixed, reserved_source<(1ul << 20)>>;
+        arena a;
+        auto p = a.allocate(10ul);
+        p[9] = 1.;
+        arena b(std::move(a));
+        REQUIRE_THAT(a.chunk_count(), Equals(0ul));
+        arena c;
+        auto q = c.allocate(1ul);
+        swap(b, c);
+        REQUIRE(c.allocate(1ul) == &p[10]);
+        REQUIRE(b.allocate(1ul) == &q[1]);
+        a = std::move(c);
+        REQUIRE_THAT(p[9], Equals(1.));
+        a.deallocate(p, 10ul);
+    }
+}
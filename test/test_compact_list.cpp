@@ -0,0 +1,141 @@
+#include <catch2/catch.hpp>
+
+#include <list>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <allocator.h>
+#include <compact_list.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace griha;
+using namespace Catch::Matchers;
+
+namespace {
+
+template <typename List, typename Ref>
+bool same(const List& l, const Ref& ref) {
+    return l.size() == ref.size() && equal(l.begin(), l.end(), ref.begin(), ref.end()) &&
+           equal(make_reverse_iterator(l.end()), make_reverse_iterator(l.begin()), ref.rbegin(), ref.rend());
+}
+
+} // namespace
+
+TEST_CASE("compact_list") {
+    SECTION("construction") {
+        compact_list<pair<int, float>> clist;
+        REQUIRE(clist.empty());
+        REQUIRE_THAT(clist.size(), Equals(0ul));
+        REQUIRE_THAT(clist.capacity(), Equals(0ul));
+        REQUIRE(clist.begin() == clist.end());
+        REQUIRE(clist.cbegin() == clist.cend());
+    }
+
+    SECTION("insertion and erasure") {
+        compact_list<string, uint32_t, 4> clist;
+        clist.push_back("b");
+        clist.emplace_back(1, 'c');
+        clist.push_front("a");
+        auto it = clist.begin();
+        ++it;
+        it = clist.emplace(it, "x");
+        REQUIRE_THAT(*it, Equals("x"));
+        REQUIRE(same(clist, vector<string>({"a", "x", "b", "c"})));
+        REQUIRE_THAT(clist.front(), Equals("a"));
+        REQUIRE_THAT(clist.back(), Equals("c"));
+
+        clist.erase(it);
+        clist.pop_back();
+        REQUIRE(same(clist, vector<string>({"a", "b"})));
+        clist.pop_front();
+        REQUIRE(same(clist, vector<string>({"b"})));
+        clist.erase(clist.end());
+        REQUIRE_THAT(clist.size(), Equals(1ul));
+    }
+
+    SECTION("slots are reused") {
+        compact_list<int, uint32_t, 16> clist;
+        for (int i = 0; i < 20; ++i)
+            clist.push_back(i);
+        REQUIRE_THAT(clist.capacity(), Equals(32ul));
+
+        // references stay valid while segments are added
+        auto& last = clist.back();
+        auto index = (--clist.end()).index();
+        for (int i = 0; i < 10; ++i)
+            clist.pop_front();
+        for (int i = 0; i < 22; ++i)
+            clist.push_front(i);
+        REQUIRE_THAT(clist.capacity(), Equals(32ul));
+        clist.push_back(100);
+        REQUIRE_THAT(clist.capacity(), Equals(48ul));
+        REQUIRE(&last == &*(--(--clist.end())));
+        REQUIRE(last == 19);
+        REQUIRE((--(--clist.end())).index() == index);
+
+        clist.clear();
+        REQUIRE(clist.empty());
+        REQUIRE_THAT(clist.capacity(), Equals(48ul));
+    }
+
+    SECTION("random operations") {
+        compact_list<int, uint32_t, 8, allocator_arena<int, 64>> clist;
+        list<int> ref;
+        mt19937 gen(11);
+        for (int i = 0; i < 2000; ++i) {
+            auto pos = gen() % (ref.size() + 1);
+            auto it = clist.begin();
+            auto rit = ref.begin();
+            advance(it, pos);
+            advance(rit, pos);
+            if (gen() % 3 == 0 && rit != ref.end()) {
+                clist.erase(it);
+                ref.erase(rit);
+            } else {
+                clist.emplace(it, i);
+                ref.emplace(rit, i);
+            }
+        }
+        REQUIRE(same(clist, ref));
+    }
+
+    SECTION("copy and assignment") {
+        compact_list<int, uint16_t, 8> clist;
+        vector<int> values(20);
+        iota(values.begin(), values.end(), 0);
+        clist.insert(clist.end(), values.begin(), values.end());
+
+        auto copy = clist;
+        REQUIRE(same(copy, values));
+
+        copy.assign({7, 8});
+        REQUIRE(same(copy, vector<int>({7, 8})));
+        REQUIRE_THAT(copy.capacity(), Equals(24ul));
+
+        copy = clist;
+        REQUIRE(same(copy, values));
+        REQUIRE_THAT(copy.capacity(), Equals(24ul));
+
+        auto moved = std::move(copy);
+        REQUIRE(same(moved, values));
+        REQUIRE(copy.empty());
+    }
+
+    SECTION("exhausted indices") {
+        compact_list<int, uint8_t, 16> clist;
+        for (int i = 0; i < 240; ++i)
+            clist.push_back(i);
+        REQUIRE_THROWS_AS(clist.push_back(240), length_error);
+        REQUIRE_THAT(clist.size(), Equals(240ul));
+
+        clist.pop_front();
+        clist.push_back(240);
+        REQUIRE_THAT(clist.front(), Equals(1));
+        REQUIRE_THAT(clist.back(), Equals(240));
+    }
+}
@@ -0,0 +1,96 @@
+#include <catch2/catch.hpp>
+
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <tuple>
+
+#include <concurrent_allocator.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace griha;
+using namespace Catch::Matchers;
+
+TEST_CASE("concurrent allocation") {
+    SECTION("single thread behaves as allocator_arena") {
+        concurrent_allocator_arena<double, 10ul> alloc;
+        auto p1 = alloc.allocate(6ul);
+        auto p2 = alloc.allocate(4ul);
+        REQUIRE(&p1[6ul] == p2);
+        alloc.deallocate(p2, 4ul);
+        REQUIRE(alloc.allocate(2ul) == p2);
+
+        auto p3 = alloc.allocate(1ul);
+        alloc.deallocate(p3, 1ul);
+        REQUIRE(alloc.allocate(1ul) == p3);
+    }
+
+    SECTION("remote free is returned to owner") {
+        concurrent_allocator_arena<int, 10ul> alloc;
+        auto p1 = alloc.allocate(10ul);
+        thread([&] { alloc.deallocate(&p1[2], 3ul); }).join();
+        REQUIRE(alloc.allocate(3ul) == &p1[2]);
+    }
+
+    SECTION("stress") {
+        // every thread allocates blocks and passes half of them to its neighbour for freeing
+        constexpr size_t threads_n = 8ul;
+        constexpr size_t rounds_n = 2000ul;
+
+        concurrent_allocator_arena<size_t, 16ul> alloc;
+        std::vector<std::vector<tuple<size_t*, size_t, size_t>>> mailboxes(threads_n);
+        std::vector<std::mutex> mutexes(threads_n);
+        std::atomic<size_t> corrupted = {0};
+
+        auto check = [&corrupted] (size_t* p, size_t n, size_t tag) {
+            for (size_t i = 0; i < n; ++i)
+                if (p[i] != tag)
+                    ++corrupted;
+        };
+
+        std::vector<thread> workers;
+        for (size_t t = 0; t < threads_n; ++t)
+            workers.emplace_back([&, t] {
+                std::vector<tuple<size_t*, size_t, size_t>> own;
+                for (size_t r = 0; r < rounds_n; ++r) {
+                    auto n = 1 + (r * 7 + t) % 16;
+                    auto p = alloc.allocate(n);
+                    auto tag = (t << 32) | r;
+                    for (size_t i = 0; i < n; ++i)
+                        p[i] = tag;
+
+                    if (r % 2 == 0) {
+                        std::lock_guard<std::mutex> lock(mutexes[(t + 1) % threads_n]);
+                        mailboxes[(t + 1) % threads_n].emplace_back(p, n, tag);
+                    } else
+                        own.emplace_back(p, n, tag);
+
+                    std::vector<tuple<size_t*, size_t, size_t>> received;
+                    {
+                        std::lock_guard<std::mutex> lock(mutexes[t]);
+                        received.swap(mailboxes[t]);
+                    }
+                    for (auto& [p, n, tag] : received) {
+                        check(p, n, tag);
+                        alloc.deallocate(p, n);
+                    }
+                    if (own.size() > 32ul) {
+                        for (auto& [p, n, tag] : own) {
+                            check(p, n, tag);
+                            alloc.deallocate(p, n);
+                        }
+                        own.clear();
+                    }
+                }
+                for (auto& e : own)
+                    alloc.deallocate(get<0>(e), get<1>(e));
+            });
+        for (auto& w : workers)
+            w.join();
+
+        REQUIRE_THAT(corrupted.load(), Equals(0ul));
+    }
+}
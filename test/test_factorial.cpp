@@ -1,6 +1,11 @@
 #include <catch2/catch.hpp>
 
+#include <random>
+#include <stdexcept>
+#include <utility>
+
 #include <factorial.h>
+#include <parallel_factorial.h>
 
 #include "utils.h"
 
@@ -26,4 +31,99 @@ TEST_CASE("factorial") {
         REQUIRE_THAT(fact(4ul), Equals(24ul));
         REQUIRE_THAT(fact(10ul), Equals(3628800ul));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("factorial table") {
+    static_assert(factorial64_v<20> == 2432902008176640000ull);
+    static_assert(fact64(13) == 6227020800ull);
+
+    REQUIRE_THAT(factorial_table.size(), Equals(21ul));
+    for (unsigned i = 1; i < factorial_table.size(); ++i)
+        REQUIRE(factorial_table[i] == factorial_table[i - 1] * i);
+
+    REQUIRE_THROWS_AS(fact64(21), overflow_error);
+    REQUIRE_THROWS_AS(fact(13), overflow_error);
+    REQUIRE_THAT(fact(12), Equals(479001600u));
+}
+
+TEST_CASE("big_uint") {
+    SECTION("arithmetic") {
+        big_uint a(0xffffffffffffffffull);
+        REQUIRE_THAT((a + big_uint(1)).to_string(), Equals("18446744073709551616"));
+        REQUIRE_THAT((a * a).to_string(), Equals("340282366920938463426481119284349108225"));
+
+        big_uint b(1);
+        b <<= 100;
+        REQUIRE_THAT(b.to_string(), Equals("1267650600228229401496703205376"));
+        REQUIRE_THAT(b.bit_length(), Equals(101ul));
+        REQUIRE(a < b);
+        REQUIRE_FALSE(b < a);
+
+        b *= 0u;
+        REQUIRE(b.is_zero());
+        REQUIRE_THAT(b.to_string(), Equals("0"));
+        REQUIRE((a * big_uint()).is_zero());
+    }
+
+    SECTION("karatsuba agrees with schoolbook") {
+        mt19937_64 gen(3);
+        auto random = [&gen] (size_t limbs) {
+            big_uint ret;
+            for (size_t i = 0; i < limbs; ++i) {
+                ret <<= 32;
+                ret += big_uint(gen() & 0xffffffffu);
+            }
+            return ret;
+        };
+        for (auto [an, bn] : {pair(32ul, 32ul), pair(100ul, 40ul), pair(257ul, 255ul), pair(1000ul, 33ul)}) {
+            auto a = random(an), b = random(bn);
+            REQUIRE(a * b == multiply_schoolbook(a, b));
+            REQUIRE(b * a == multiply_schoolbook(a, b));
+        }
+
+        // all limbs at maximum stress carries
+        big_uint m;
+        for (size_t i = 0; i < 300; ++i) {
+            m <<= 32;
+            m += big_uint(0xffffffffu);
+        }
+        REQUIRE(m * m == multiply_schoolbook(m, m));
+    }
+}
+
+TEST_CASE("big factorial") {
+    SECTION("agrees with table") {
+        for (unsigned i = 0; i <= 20; ++i)
+            REQUIRE(big_fact(i) == big_uint(fact64(i)));
+    }
+
+    SECTION("large values") {
+        REQUIRE_THAT(big_fact(25).to_string(), Equals("15511210043330985984000000"));
+
+        auto digits = big_fact(1000).to_string();
+        REQUIRE_THAT(digits.size(), Equals(2568ul));
+        unsigned sum = 0;
+        for (auto d : digits)
+            sum += d - '0';
+        REQUIRE_THAT(sum, Equals(10539u));
+
+        // naive product agrees
+        big_uint naive(1);
+        for (unsigned i = 2; i <= 3000; ++i)
+            naive *= i;
+        REQUIRE(big_fact(3000) == naive);
+
+        thread_pool pool(3);
+        REQUIRE(big_fact(3000, pool) == naive);
+        REQUIRE(big_fact(5, pool) == big_uint(120));
+    }
+
+    SECTION("binomial") {
+        REQUIRE(big_binomial(10, 3) == big_uint(120));
+        REQUIRE(big_binomial(10, 0) == big_uint(1));
+        REQUIRE(big_binomial(10, 10) == big_uint(1));
+        REQUIRE(big_binomial(3, 5).is_zero());
+        REQUIRE_THAT(big_binomial(100, 50).to_string(), Equals("100891344545564193334812497256"));
+        REQUIRE(big_binomial(300, 120) * big_fact(120) * big_fact(180) == big_fact(300));
+    }
+}
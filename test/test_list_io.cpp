@@ -0,0 +1,166 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <allocator.h>
+#include <bidirectional_list.h>
+#include <list_io.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace griha;
+using namespace Catch::Matchers;
+
+namespace {
+
+struct point {
+    double x;
+    double y;
+    int tag;
+
+    friend bool operator== (const point& lhs, const point& rhs) {
+        return lhs.x == rhs.x && lhs.y == rhs.y && lhs.tag == rhs.tag;
+    }
+};
+
+} // namespace
+
+TEST_CASE("list binary io") {
+    temp_file file("list_io.bin");
+
+    SECTION("dump and load") {
+        bidirectional_list<point, allocator_arena<point, 64>> l;
+        for (int i = 0; i < 5000; ++i)
+            l.push_back({i * 0.5, -i * 0.25, i});
+        dump(l, file.path);
+
+        bidirectional_list<point> loaded;
+        loaded.assign({{1., 1., 1}});
+        load(loaded, file.path);
+        REQUIRE(values_of(loaded) == values_of(l));
+
+        // arena gets nodes in batches next to each other
+        bidirectional_list<point, allocator_arena<point, 64>> batched;
+        load(batched, file.path);
+        REQUIRE(values_of(batched) == values_of(l));
+
+        bidirectional_list<point> empty;
+        dump(empty, file.path);
+        load(loaded, file.path);
+        REQUIRE(loaded.empty());
+    }
+
+    SECTION("chunked reading") {
+        bidirectional_list<long> l;
+        for (long i = 0; i < 10000; ++i)
+            l.push_back(i);
+        dump(l, file.path);
+
+        int fd = open(file.path.c_str(), O_RDONLY);
+        REQUIRE(fd >= 0);
+        list_reader<long> reader(fd);
+        REQUIRE_THAT(reader.size(), Equals(10000ul));
+
+        bidirectional_list<long> chunk;
+        REQUIRE_THAT(reader.read(chunk, 3000), Equals(3000ul));
+        auto front = &chunk.front();
+
+        long sum = accumulate(chunk.begin(), chunk.end(), 0l);
+        size_t chunks = 1;
+        for (size_t n; (n = reader.read(chunk, 3000)) != 0; ++chunks) {
+            REQUIRE(&chunk.front() == front); // nodes are reused
+            REQUIRE_THAT(chunk.size(), Equals(n));
+            sum += accumulate(chunk.begin(), chunk.end(), 0l);
+        }
+        close(fd);
+        REQUIRE_THAT(chunks, Equals(4ul));
+        REQUIRE(chunk.empty()); // nothing is left for the last read
+        REQUIRE_THAT(sum, Equals(10000l * 9999 / 2));
+        REQUIRE_THAT(reader.remaining(), Equals(0ul));
+    }
+
+    SECTION("large values and lists in one file") {
+        struct page {
+            char bytes[4096];
+        };
+        bidirectional_list<page> pages;
+        for (char c = 'a'; c != 'd'; ++c)
+            memset(pages.emplace_back().bytes, c, sizeof(page::bytes));
+        bidirectional_list<long> l;
+        l.assign({7, 8, 9});
+
+        int fd = open(file.path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        REQUIRE(fd >= 0);
+        dump(l, fd);
+        dump(pages, fd);
+        dump(l, fd);
+
+        // every reader stops at the end of its list
+        REQUIRE(lseek(fd, 0, SEEK_SET) == 0);
+        bidirectional_list<long> first, last;
+        bidirectional_list<page> loaded;
+        load(first, fd);
+        load(loaded, fd);
+        load(last, fd);
+        close(fd);
+        REQUIRE(values_of(first) == values_of(l));
+        REQUIRE(values_of(last) == values_of(l));
+        REQUIRE_THAT(loaded.size(), Equals(3ul));
+        REQUIRE(equal(loaded.begin(), loaded.end(), pages.begin(), [] (const page& lhs, const page& rhs) {
+            return memcmp(lhs.bytes, rhs.bytes, sizeof(lhs.bytes)) == 0;
+        }));
+    }
+
+    SECTION("malformed files") {
+        bidirectional_list<long> l;
+        l.assign({1, 2, 3});
+        dump(l, file.path);
+
+        bidirectional_list<int> ints;
+        REQUIRE_THROWS_AS(load(ints, file.path), runtime_error);
+
+        REQUIRE(truncate(file.path.c_str(), sizeof(list_file_header) + sizeof(long)) == 0);
+        REQUIRE_THROWS_WITH(load(l, file.path), "list file is truncated");
+
+        REQUIRE(truncate(file.path.c_str(), 4) == 0);
+        REQUIRE_THROWS_AS(load(l, file.path), runtime_error);
+
+        REQUIRE_THROWS_AS(load(l, file.path + ".missing"), system_error);
+
+        // count of values is checked before reading them
+        dump(l, file.path);
+        auto set_count = [&file] (uint64_t count) {
+            int fd = open(file.path.c_str(), O_WRONLY);
+            REQUIRE(pwrite(fd, &count, sizeof(count), offsetof(list_file_header, count)) == sizeof(count));
+            close(fd);
+        };
+        set_count(1ull << 40);
+        REQUIRE_THROWS_WITH(load(l, file.path), "list file is truncated");
+        set_count(1ull << 62);
+        REQUIRE_THROWS_WITH(load(l, file.path), "list file has invalid count");
+
+        // size of pipe is unknown, so its values end before the count
+        list_file_header header;
+        memcpy(header.magic, list_file_header::magic_value, sizeof(header.magic));
+        header.version = 1;
+        header.value_size = sizeof(int);
+        header.count = 5;
+        int values[] = {1, 2};
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        REQUIRE(write(fds[1], &header, sizeof(header)) == sizeof(header));
+        REQUIRE(write(fds[1], values, sizeof(values)) == sizeof(values));
+        close(fds[1]);
+        REQUIRE_THROWS_WITH(load(ints, fds[0]), "list file is truncated");
+        close(fds[0]);
+    }
+}
@@ -0,0 +1,96 @@
+#include <catch2/catch.hpp>
+
+#include <list>
+#include <map>
+#include <string>
+
+#include <memory_resource.h>
+#include <bidirectional_list.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace griha;
+using namespace Catch::Matchers;
+
+namespace {
+
+// counts allocations passed to upstream
+struct counting_resource : pmr::memory_resource {
+    size_t allocations = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        return pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+}
+
+TEST_CASE("pool resource") {
+    SECTION("containers of different types share pools") {
+        counting_resource upstream;
+        arena_pool_resource<> resource(1ul << 12, &upstream);
+        {
+            pmr::map<int, int> m(&resource);
+            pmr::list<double> l(&resource);
+            bidirectional_list<int, pmr::polymorphic_allocator<int>> bl(&resource);
+            for (int i = 0; i < 1000; ++i) {
+                m.emplace(i, i * i);
+                l.push_back(i);
+                bl.emplace(bl.end(), i);
+            }
+            for (int i = 0; i < 1000; i += 2)
+                m.erase(i);
+
+            REQUIRE_THAT(m.size(), Equals(500ul));
+            REQUIRE_THAT(m.at(999), Equals(999 * 999));
+            REQUIRE_THAT(l.back(), Equals(999.));
+            REQUIRE_THAT(bl.size(), Equals(1000ul));
+            REQUIRE(bl.get_allocator().resource() == &resource);
+        }
+        REQUIRE_THAT(upstream.allocations, Equals(0ul)); // all blocks are from pools
+    }
+
+    SECTION("blocks of various sizes and alignments") {
+        counting_resource upstream;
+        arena_pool_resource<> resource(1ul << 12, &upstream);
+        for (size_t size = 1; size <= 2 * resource.max_block; size *= 3)
+            for (size_t alignment = 1; alignment <= 64; alignment *= 2) {
+                auto p = resource.allocate(size, alignment);
+                REQUIRE(reinterpret_cast<uintptr_t>(p) % alignment == 0);
+                memset(p, 0xff, size);
+                resource.deallocate(p, size, alignment);
+            }
+        REQUIRE(upstream.allocations > 0ul); // the largest blocks
+    }
+}
+
+TEST_CASE("monotonic resource") {
+    arena_monotonic_resource<> resource(1ul << 10);
+    SECTION("bump allocation and reset") {
+        auto p1 = resource.allocate(16, 8);
+        auto p2 = resource.allocate(16, 8);
+        REQUIRE(static_cast<char*>(p1) + 16 == p2);
+        (void) resource.allocate(1ul << 12, 8); // extends to one more chunk
+
+        resource.reset();
+        REQUIRE(resource.allocate(16, 8) == p1); // memory is reused
+        resource.release();
+    }
+
+    SECTION("containers") {
+        pmr::vector<pmr::string> words(&resource);
+        for (int i = 0; i < 100; ++i)
+            words.emplace_back("a long enough string to avoid small string optimization");
+        REQUIRE_THAT(words.back(), Equals("a long enough string to avoid small string optimization"));
+    }
+}
@@ -0,0 +1,55 @@
+#include <catch2/catch.hpp>
+
+#include <map>
+
+#include <bidirectional_list.h>
+#include <monotonic_allocator.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace griha;
+using namespace Catch::Matchers;
+
+TEST_CASE("monotonic allocator") {
+    monotonic_arena<> arena(1ul << 10);
+
+    SECTION("bump allocation") {
+        monotonic_allocator<int> alloc(arena);
+        auto p1 = alloc.allocate(4ul);
+        alloc.deallocate(p1, 4ul); // does nothing
+        auto p2 = alloc.allocate(4ul);
+        REQUIRE(&p1[4ul] == p2);
+
+        monotonic_allocator<double> other(alloc);
+        REQUIRE(other == alloc);
+        auto p3 = other.allocate(1ul);
+        REQUIRE(reinterpret_cast<uintptr_t>(p3) % alignof(double) == 0ul);
+
+        monotonic_arena<> another;
+        REQUIRE(monotonic_allocator<int>(another) != alloc);
+    }
+
+    SECTION("containers and reset") {
+        monotonic_allocator<int> alloc(arena);
+        const void* first = nullptr;
+        for (int request = 0; request < 3; ++request) {
+            {
+                map<int, int, less<int>, monotonic_allocator<pair<const int, int>>> m(alloc);
+                bidirectional_list<int, monotonic_allocator<int>> l(alloc);
+                for (int i = 0; i < 100; ++i) {
+                    m.emplace(i, i);
+                    l.emplace(l.end(), i);
+                }
+                REQUIRE_THAT(m.size(), Equals(100ul));
+                REQUIRE_THAT(*l.begin(), Equals(0));
+                if (request == 0)
+                    first = &*m.begin();
+                else
+                    REQUIRE(first == &*m.begin()); // nodes of every request reuse the same memory
+            }
+            arena.reset();
+        }
+        REQUIRE(arena.chunk_count() > 1ul);
+    }
+}
@@ -0,0 +1,113 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <allocator.h>
+#include <bidirectional_list.h>
+#include <compact_list.h>
+#include <parallel.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace griha;
+using namespace Catch::Matchers;
+
+namespace {
+
+template <typename List>
+void check_algorithms(thread_pool& pool, size_t n) {
+    List l;
+    for (size_t i = 0; i < n; ++i)
+        l.push_back(int(i));
+
+    auto expected_sum = 0ll;
+    for (auto v : l)
+        expected_sum += 2ll * v;
+    REQUIRE_THAT(parallel::transform_reduce(pool, l, 0ll, plus<>(), [] (int v) { return 2ll * v; }),
+                 Equals(expected_sum));
+    REQUIRE_THAT(parallel::count_if(pool, l, [] (int v) { return v % 3 == 0; }), Equals((n + 2) / 3));
+
+    parallel::for_each(pool, l, [] (int& v) { v += 1; });
+    vector<int> expected(n);
+    iota(expected.begin(), expected.end(), 1);
+    REQUIRE(vector<int>(l.begin(), l.end()) == expected);
+
+    // segments are reused by several passes
+    const auto& cl = l;
+    auto segments = split(cl, 7);
+    REQUIRE(parallel::count_if(pool, segments, [] (int v) { return v > 0; }) == n);
+    // reduction keeps list order
+    auto digits = parallel::transform_reduce(pool, segments, string(), plus<>(),
+                                             [] (int v) { return to_string(v % 10); });
+    string expected_digits;
+    for (auto v : expected)
+        expected_digits += to_string(v % 10);
+    REQUIRE(digits == expected_digits);
+}
+
+} // namespace
+
+TEST_CASE("thread_pool") {
+    SECTION("all tasks run once") {
+        thread_pool pool(4);
+        REQUIRE_THAT(pool.size(), Equals(4ul));
+        vector<atomic<int>> counts(1000);
+        for (int pass = 0; pass < 10; ++pass)
+            pool.run(counts.size(), [&] (size_t i) { ++counts[i]; });
+        for (auto& c : counts)
+            REQUIRE(c.load() == 10);
+        pool.run(0, [] (size_t) { FAIL("no tasks expected"); });
+    }
+
+    SECTION("exceptions") {
+        thread_pool pool(3);
+        REQUIRE_THROWS_AS(pool.run(100, [] (size_t i) {
+            if (i == 42)
+                throw runtime_error("task");
+        }), runtime_error);
+
+        atomic<size_t> n = {0};
+        pool.run(100, [&] (size_t) { ++n; });
+        REQUIRE(n.load() == 100);
+    }
+}
+
+TEST_CASE("list_segments") {
+    bidirectional_list<int> l;
+    for (int i = 0; i < 10; ++i)
+        l.push_back(i);
+
+    auto segments = split(l, 4);
+    REQUIRE_THAT(segments.size(), Equals(4ul));
+    vector<size_t> lengths;
+    for (size_t i = 0; i < segments.size(); ++i)
+        lengths.push_back(distance(segments.begin(i), segments.end(i)));
+    REQUIRE(lengths == vector<size_t>({3, 3, 2, 2}));
+    REQUIRE(segments.begin(0) == l.begin());
+    REQUIRE(segments.end(3) == l.end());
+
+    REQUIRE_THAT(split(l, 100).size(), Equals(10ul));
+
+    bidirectional_list<int> empty;
+    auto none = split(empty, 4);
+    REQUIRE_THAT(none.size(), Equals(0ul));
+    thread_pool pool(2);
+    REQUIRE_THAT(parallel::count_if(pool, empty, [] (int) { return true; }), Equals(0ul));
+    REQUIRE_THAT(parallel::transform_reduce(pool, empty, 5, plus<>(), [] (int v) { return v; }), Equals(5));
+}
+
+TEST_CASE("parallel algorithms") {
+    for (size_t threads : {1ul, 2ul, 5ul}) {
+        thread_pool pool(threads);
+        for (size_t n : {1ul, 13ul, 1000ul}) {
+            check_algorithms<bidirectional_list<int>>(pool, n);
+            check_algorithms<bidirectional_list<int, allocator_arena<int, 64>>>(pool, n);
+            check_algorithms<compact_list<int>>(pool, n);
+        }
+    }
+}
@@ -0,0 +1,215 @@
+#include <catch2/catch.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <bidirectional_list.h>
+#include <offset_ptr.h>
+#include <persistent_arena.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace griha;
+using namespace Catch::Matchers;
+
+namespace {
+
+using list_type = bidirectional_list<long, persistent_allocator<long>>;
+
+constexpr size_t capacity = 16ul << 20;
+
+} // namespace
+
+TEST_CASE("offset_ptr") {
+    struct link {
+        long value;
+        offset_ptr<link> next;
+    };
+    vector<char> a(sizeof(link) * 2), b(sizeof(link) * 2);
+    auto la = reinterpret_cast<link*>(a.data());
+    la[0] = {1, &la[1]};
+    la[1] = {2, nullptr};
+
+    // bytes are copied to another address, links follow them
+    b = a;
+    auto lb = reinterpret_cast<link*>(b.data());
+    REQUIRE(lb[0].next.get() == &lb[1]);
+    REQUIRE_THAT(lb[0].next->value, Equals(2l));
+    REQUIRE(lb[1].next == nullptr);
+
+    // copy of pointer points to the same object
+    offset_ptr<link> p = la[0].next;
+    REQUIRE(p == la[0].next);
+    REQUIRE(p - offset_ptr<link>(la) == 1);
+    offset_ptr<const link> cp = p;
+    REQUIRE_THAT((--cp)->value, Equals(1l));
+    offset_ptr<void> vp = p;
+    REQUIRE(static_cast<offset_ptr<link>>(vp) == p);
+}
+
+TEST_CASE("persistent arena") {
+    temp_file file("persistent.arena");
+
+    SECTION("blocks are reused by size") {
+        persistent_arena arena(file.path, capacity);
+        REQUIRE(arena.created());
+        auto used = arena.used();
+        auto p1 = arena.allocate(24);
+        auto p2 = arena.allocate(2000);
+        arena.deallocate(p1, 24);
+        arena.deallocate(p2, 2000);
+        REQUIRE(arena.allocate(32) == p1); // the same size class
+        REQUIRE(arena.allocate(1500) == p2);
+        REQUIRE(arena.allocate(496) == static_cast<char*>(p2) + 1504); // rest of large block
+        REQUIRE_THAT(arena.used(), Equals(used + 32 + 2000));
+        REQUIRE_THROWS_AS(arena.allocate(capacity), std::bad_alloc);
+    }
+
+    SECTION("list reopened at another address") {
+        const void* first_address;
+        {
+            persistent_arena arena(file.path, capacity);
+            auto& l = arena.construct<list_type>("list", persistent_allocator<long>(arena));
+            for (long i = 0; i < 1000; ++i)
+                l.push_back(i);
+            l.remove_if([] (long v) { return v % 2 != 0; });
+            l.sort(greater<>());
+            first_address = arena.segment();
+        }
+
+        // the old address is taken, so the file is mapped elsewhere
+        auto placeholder = mmap(const_cast<void*>(first_address), capacity, PROT_NONE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        REQUIRE(placeholder != MAP_FAILED);
+        {
+            persistent_arena arena(file.path, capacity);
+            REQUIRE_FALSE(arena.created());
+            REQUIRE(static_cast<const void*>(arena.segment()) != first_address);
+            REQUIRE_THROWS_AS(arena.find<int>("list"), std::invalid_argument);
+            REQUIRE(arena.find<list_type>("other") == nullptr);
+
+            auto l = arena.find<list_type>("list");
+            REQUIRE(l != nullptr);
+            REQUIRE_THAT(l->size(), Equals(500ul));
+            REQUIRE_THAT(l->front(), Equals(998l));
+            REQUIRE_THAT(l->back(), Equals(0l));
+
+            // list is modified in place and reallocates freed nodes
+            auto used = arena.used();
+            l->remove_if([] (long v) { return v >= 10; });
+            l->push_front(-1);
+            l->insert(l->end(), {-2, -3});
+            REQUIRE(values_of(*l) == vector<long>({-1, 8, 6, 4, 2, 0, -2, -3}));
+            REQUIRE_THAT(arena.used(), Equals(used));
+
+            arena.destroy<list_type>("list");
+            REQUIRE(arena.find<list_type>("list") == nullptr);
+        }
+        munmap(placeholder, capacity);
+    }
+
+    SECTION("uncommitted allocations are discarded") {
+        {
+            persistent_arena arena(file.path, capacity);
+            arena.construct<list_type>("list", persistent_allocator<long>(arena)).assign({1, 2, 3});
+        }
+        {
+            persistent_arena arena(file.path, capacity);
+            auto used = arena.used();
+            auto l = arena.find<list_type>("list");
+            l->push_back(4);
+            arena.sync();
+            auto committed = arena.used();
+            REQUIRE(committed > used);
+            arena.allocate(4096);
+
+            // copy of the file taken before destruction looks as after crash
+            temp_file copy("persistent.copy");
+            filesystem::copy_file(file.path, copy.path);
+            persistent_arena crashed(copy.path, capacity);
+            REQUIRE_THAT(crashed.used(), Equals(committed));
+            REQUIRE_THAT(crashed.find<list_type>("list")->size(), Equals(4ul));
+        }
+    }
+
+    SECTION("free blocks reused after commit") {
+        auto offset = [] (persistent_arena& arena, void* p) {
+            return static_cast<char*>(p) - reinterpret_cast<char*>(arena.segment());
+        };
+        ptrdiff_t freed;
+        {
+            persistent_arena arena(file.path, capacity);
+            auto p1 = arena.allocate(64);
+            auto p2 = arena.allocate(64);
+            arena.deallocate(p1, 64);
+            arena.deallocate(p2, 64);
+            freed = offset(arena, p2);
+        }
+        persistent_arena arena(file.path, capacity);
+        auto used = arena.used();
+        auto p = arena.allocate(64);
+        REQUIRE(offset(arena, p) == freed); // free lists are kept by clean close
+        memset(p, 0x5a, 64); // link to the next free block is overwritten
+
+        temp_file copy("persistent.copy");
+        filesystem::copy_file(file.path, copy.path);
+        persistent_arena crashed(copy.path, capacity);
+        auto p1 = crashed.allocate(64);
+        auto p2 = crashed.allocate(64);
+        REQUIRE(p1 != p2);
+        REQUIRE_THAT(crashed.used(), Equals(used + 128)); // free blocks of the commit are leaked
+    }
+
+    SECTION("corrupted file") {
+        {
+            auto f = fopen(file.path.c_str(), "w");
+            fputs("not an arena", f);
+            fclose(f);
+        }
+        REQUIRE_THROWS_AS(persistent_arena(file.path, capacity), std::runtime_error);
+    }
+}
+
+TEST_CASE("persistent arena between processes") {
+    temp_file file("persistent.arena");
+
+    // child process builds the list and exits, parent reopens the file
+    auto pid = fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+        int code = 1;
+        try {
+            persistent_arena arena(file.path, capacity);
+            auto& l = arena.construct<list_type>("list", persistent_allocator<long>(arena));
+            for (long i = 0; i < 100000; ++i)
+                l.push_back(i * i);
+            code = 0;
+        } catch (...) {
+        }
+        _exit(code);
+    }
+
+    int status = 0;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE_THAT(WEXITSTATUS(status), Equals(0));
+
+    persistent_arena arena(file.path, capacity);
+    auto l = arena.find<list_type>("list");
+    REQUIRE(l != nullptr);
+    REQUIRE_THAT(l->size(), Equals(100000ul));
+    long i = 0;
+    bool equal = true;
+    for (auto v : *l) {
+        equal &= v == i * i;
+        ++i;
+    }
+    REQUIRE(equal);
+}
@@ -0,0 +1,74 @@
+#include <catch2/catch.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <bidirectional_list.h>
+#include <shared_arena.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace griha;
+using namespace Catch::Matchers;
+
+TEST_CASE("shared_arena_allocator") {
+    SECTION("equality and rebinding") {
+        shared_arena_allocator<int, 64> a;
+        shared_arena_allocator<int, 64> b;
+        REQUIRE(a == a);
+        REQUIRE(a != b);
+
+        auto c = a;
+        REQUIRE(c == a);
+        REQUIRE_THAT(a.group().use_count(), Equals(2l));
+
+        shared_arena_allocator<double, 64> d(a);
+        REQUIRE(d == a);
+        REQUIRE(shared_arena_allocator<int, 64>(d) == a);
+        REQUIRE(d != b);
+
+        // int and float share arena of 4 byte elements
+        shared_arena_allocator<float, 64> f(a);
+        REQUIRE_THAT(a.group()->arena_count(), Equals(2ul));
+    }
+
+    SECTION("allocation") {
+        shared_arena_allocator<int, 64> a;
+        shared_arena_allocator<float, 64> f(a);
+        auto p = a.allocate(10);
+        auto q = f.allocate(1);
+        for (int i = 0; i < 10; ++i)
+            p[i] = i;
+        *q = 1.f;
+        a.deallocate(p, 10);
+        f.deallocate(q, 1);
+
+        auto moved = std::move(a);
+        REQUIRE(moved == a); // handle is copied on move
+    }
+
+    SECTION("group outlives handles") {
+        bidirectional_list<string, shared_arena_allocator<string, 64>> l;
+        {
+            shared_arena_allocator<string, 64> a;
+            bidirectional_list<string, shared_arena_allocator<string, 64>> t(a);
+            t.push_back("value");
+            l = std::move(t);
+        }
+        REQUIRE_THAT(l.front(), Equals("value"));
+    }
+
+    SECTION("standard containers") {
+        shared_arena_allocator<pair<const int, int>, 64> a;
+        map<int, int, less<int>, shared_arena_allocator<pair<const int, int>, 64>> m(a);
+        for (int i = 0; i < 1000; ++i)
+            m.emplace(i, i);
+        auto copy = m;
+        REQUIRE(copy.get_allocator() == m.get_allocator());
+        m.clear();
+        REQUIRE_THAT(copy.size(), Equals(1000ul));
+    }
+}
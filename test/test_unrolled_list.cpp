@@ -0,0 +1,193 @@
+#include <catch2/catch.hpp>
+
+#include <list>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <allocator.h>
+#include <unrolled_list.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace griha;
+using namespace Catch::Matchers;
+
+namespace {
+
+template <typename List, typename Ref>
+bool same(const List& l, const Ref& ref) {
+    return l.size() == ref.size() && equal(l.begin(), l.end(), ref.begin(), ref.end());
+}
+
+// elements of node are adjacent in memory, so nodes are told apart by addresses
+template <typename List>
+vector<size_t> node_sizes(const List& l) {
+    vector<size_t> ret;
+    const typename List::value_type* last = nullptr;
+    for (auto& v : l) {
+        if (last == nullptr || &v != last + 1)
+            ret.push_back(0);
+        ++ret.back();
+        last = &v;
+    }
+    return ret;
+}
+
+} // namespace
+
+TEST_CASE("unrolled_list") {
+    SECTION("construction") {
+        unrolled_list<pair<int, float>> ulist;
+        REQUIRE(ulist.empty());
+        REQUIRE_THAT(ulist.size(), Equals(0ul));
+        REQUIRE(ulist.begin() == ulist.end());
+        REQUIRE(ulist.cbegin() == ulist.cend());
+    }
+
+    SECTION("emplace") {
+        unrolled_list<pair<int, float>, 2> ulist;
+        auto it = ulist.emplace(ulist.end(), 1, 1.);
+        REQUIRE(it == ulist.begin());
+        REQUIRE_THAT(ulist.size(), Equals(1ul));
+
+        ulist.emplace(ulist.end(), 2, 2.);
+        it = ulist.emplace(ulist.begin(), 3, 3.); // splits full node
+        REQUIRE(it == ulist.begin());
+
+        it = ulist.begin();
+        ++it;
+        it = ulist.emplace(it, 4, 4.);
+        REQUIRE_THAT(*it, Equals(make_pair(4, 4.f)));
+        REQUIRE_THAT(ulist.size(), Equals(4ul));
+
+        it = ulist.begin();
+        REQUIRE_THAT(*it, Equals(make_pair(3, 3.f)));
+        ++it;
+        REQUIRE_THAT(*it, Equals(make_pair(4, 4.f)));
+        ++it;
+        REQUIRE_THAT(*it, Equals(make_pair(1, 1.f)));
+        ++it;
+        REQUIRE_THAT(it->first, Equals(2));
+        ++it;
+        REQUIRE(it == ulist.end());
+        --it;
+        REQUIRE_THAT(it->first, Equals(2));
+    }
+
+    SECTION("erase") {
+        unrolled_list<int, 4> ulist;
+        for (int i = 0; i < 10; ++i)
+            ulist.emplace(ulist.end(), i);
+
+        auto it = ulist.begin();
+        advance(it, 3);
+        it = ulist.erase(it);
+        REQUIRE_THAT(*it, Equals(4));
+        for (; it != ulist.end();)
+            it = ulist.erase(it); // merges underfilled nodes
+        REQUIRE(same(ulist, vector<int>{0, 1, 2}));
+
+        it = ulist.end();
+        --it;
+        ulist.erase(it);
+        ulist.erase(ulist.begin());
+        ulist.erase(ulist.begin());
+        REQUIRE(ulist.empty());
+        REQUIRE(ulist.begin() == ulist.end());
+    }
+
+    SECTION("erasure keeps nodes half full") {
+        unrolled_list<int, 8> ulist;
+        vector<int> kept;
+        for (int i = 0; i < 128; ++i) {
+            ulist.emplace(ulist.end(), i);
+            if (i % 8 == 0)
+                kept.push_back(i);
+        }
+        auto half_full = [&ulist] {
+            auto sizes = node_sizes(ulist);
+            return all_of(sizes.begin(), sizes.end(), [] (size_t n) { return n >= 4; });
+        };
+
+        // all but the first element of every node are erased from front to back
+        auto copy = ulist;
+        for (auto it = copy.begin(); it != copy.end();)
+            it = *it % 8 != 0 ? copy.erase(it) : next(it);
+        REQUIRE(same(copy, kept));
+        swap(copy, ulist);
+        REQUIRE(half_full());
+        swap(copy, ulist);
+
+        // and from back to front, every erasure returns iterator to the following element
+        for (auto pos = ulist.size(); pos-- != 0;) {
+            auto it = next(ulist.begin(), static_cast<ptrdiff_t>(pos));
+            if (*it % 8 == 0)
+                continue;
+            auto following = next(it) != ulist.end() ? *next(it) : -1;
+            it = ulist.erase(it);
+            REQUIRE((it != ulist.end() ? *it : -1) == following);
+        }
+        REQUIRE(same(ulist, kept));
+        REQUIRE(half_full());
+    }
+
+    SECTION("random insertion and erasure") {
+        unrolled_list<string, 8> ulist;
+        list<string> ref;
+        mt19937 gen(1);
+        for (int step = 0; step < 2000; ++step) {
+            auto pos = ref.empty() ? 0ul : gen() % (ref.size() + 1);
+            auto uit = ulist.begin();
+            auto rit = ref.begin();
+            advance(uit, pos);
+            advance(rit, pos);
+            if (gen() % 3 != 0 || pos == ref.size()) {
+                auto v = to_string(step) + " long enough to defeat small string optimization";
+                REQUIRE(*ulist.emplace(uit, v) == *ref.emplace(rit, v));
+            } else {
+                auto next = ulist.erase(uit);
+                auto rnext = ref.erase(rit);
+                REQUIRE((next == ulist.end()) == (rnext == ref.end()));
+                if (rnext != ref.end())
+                    REQUIRE(*next == *rnext);
+            }
+        }
+        REQUIRE(same(ulist, ref));
+        REQUIRE(equal(make_reverse_iterator(ulist.end()), make_reverse_iterator(ulist.begin()),
+                      ref.rbegin(), ref.rend()));
+    }
+
+    SECTION("copy, move and swap") {
+        unrolled_list<int, 4> ulist;
+        vector<int> values(10);
+        iota(begin(values), end(values), 1);
+        for (auto v : values)
+            ulist.emplace(ulist.end(), v);
+
+        unrolled_list<int, 4> ulist_copy(ulist);
+        REQUIRE(same(ulist_copy, values));
+
+        unrolled_list<int, 4> ulist_move(move(ulist_copy));
+        REQUIRE(same(ulist_move, values));
+        REQUIRE(ulist_copy.empty());
+
+        unrolled_list<int, 4> other;
+        other.emplace(other.end(), 100);
+        swap(other, ulist_move);
+        REQUIRE(same(other, values));
+        REQUIRE(same(ulist_move, vector<int>{100}));
+
+        ulist_move = other;
+        REQUIRE(same(ulist_move, values));
+    }
+
+    SECTION("arena allocator") {
+        unrolled_list<int, 16, allocator_arena<int, 8ul>> ulist;
+        for (int i = 0; i < 1000; ++i)
+            ulist.emplace(ulist.end(), i);
+        REQUIRE_THAT(accumulate(ulist.begin(), ulist.end(), 0), Equals(999 * 1000 / 2));
+    }
+}
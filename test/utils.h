@@ -2,7 +2,12 @@
 
 #include <catch2/catch.hpp>
 
+#include <cstdio>
 #include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
 
 template<typename T>
 class equals : public Catch::MatcherBase<T> {
@@ -31,6 +36,24 @@ inline auto Equals(const char* str) {
     return equals<std::string_view>(str);
 }
 
+// file in /tmp unique for the process, removed on construction and with the guard
+struct temp_file {
+    explicit temp_file(const std::string& name)
+        : path("/tmp/griha_" + std::to_string(getpid()) + '_' + name) { std::remove(path.c_str()); }
+    ~temp_file() { std::remove(path.c_str()); }
+
+    temp_file(const temp_file&) = delete;
+    temp_file& operator= (const temp_file&) = delete;
+
+    std::string path;
+};
+
+// elements of container in order of traversal
+template <typename Container>
+std::vector<typename Container::value_type> values_of(const Container& c) {
+    return {c.begin(), c.end()};
+}
+
 namespace std {
 
 template<typename Ch, typename T1, typename T2>